@@ -0,0 +1,121 @@
+#ifndef EELS_BENCHMARKS_BENCHMARK_H_
+#define EELS_BENCHMARKS_BENCHMARK_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(EELS_EXPECTED_INSTRUMENT)
+#include <eels/expected/instrumentation.h>
+#endif
+
+// Minimal benchmark harness: each benchmark runs its body for a number of iterations,
+// doubled until the run is long enough to be measured, then reports the time per iteration.
+
+namespace eels { namespace benchmarks {
+
+typedef void (*benchmark_function)(std::size_t iterations);
+
+class benchmark
+{
+public:
+    benchmark(const char* name, benchmark_function function) : name(name), function(function) { }
+
+    const char* name;
+    benchmark_function function;
+};
+
+inline std::vector<benchmark>& registry()
+{
+    static std::vector<benchmark> benchmarks;
+    return benchmarks;
+}
+
+class registration
+{
+public:
+    registration(const char* name, benchmark_function function) { registry().push_back(benchmark(name, function)); }
+};
+
+#if defined(_MSC_VER)
+extern const volatile void* volatile sink;
+#endif
+
+// Forces the compiler to compute 'value' without letting it know what is done with it.
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(_MSC_VER)
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+#if defined(EELS_EXPECTED_INSTRUMENT)
+inline void print_counters(const expected_counters& counters, std::size_t iterations)
+{
+    const double n = static_cast<double>(iterations);
+    std::printf("    per iteration: %.2f constructions (%.2f errors), %.2f value to error, %.2f error to value, %.2f copies, %.2f moves\n",
+                static_cast<double>(counters.constructions) / n, static_cast<double>(counters.error_constructions) / n,
+                static_cast<double>(counters.value_to_error_switches) / n, static_cast<double>(counters.error_to_value_switches) / n,
+                static_cast<double>(counters.copies) / n, static_cast<double>(counters.moves) / n);
+}
+#endif
+
+// Runs the benchmarks whose name contains 'filter', or all of them when it is null.
+// Instrumented builds also print what expected objects did during each iteration of the last run, on any thread.
+inline int run(const char* filter)
+{
+    typedef std::chrono::steady_clock clock;
+    const clock::duration minimum_duration = std::chrono::milliseconds(200);
+
+    for(std::vector<benchmark>::const_iterator it = registry().begin(); it != registry().end(); ++it)
+    {
+        if(filter && !std::strstr(it->name, filter))
+            continue;
+
+        std::size_t iterations = 1;
+        clock::duration elapsed;
+#if defined(EELS_EXPECTED_INSTRUMENT)
+        expected_counters counters;
+#endif
+        for(;;)
+        {
+#if defined(EELS_EXPECTED_INSTRUMENT)
+            const expected_counters before = expected_counters_snapshot();
+#endif
+            const clock::time_point start = clock::now();
+            it->function(iterations);
+            elapsed = clock::now() - start;
+#if defined(EELS_EXPECTED_INSTRUMENT)
+            counters = expected_counters_snapshot() - before;
+#endif
+            if(elapsed >= minimum_duration)
+                break;
+            iterations *= 2;
+        }
+
+        const double nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+        std::printf("%-60s %12.2f ns %12lu iterations\n", it->name, nanoseconds, static_cast<unsigned long>(iterations));
+#if defined(EELS_EXPECTED_INSTRUMENT)
+        print_counters(counters, iterations);
+#endif
+    }
+    return 0;
+}
+
+} }
+
+#define EELS_BENCHMARK(name) \
+    static void name(std::size_t iterations); \
+    static const ::eels::benchmarks::registration name##_registration(#name, &name); \
+    static void name(std::size_t iterations)
+
+#endif // EELS_BENCHMARKS_BENCHMARK_H_
@@ -0,0 +1,124 @@
+#include <eels/config.h>
+
+#if !defined(EELS_NO_CXX20_COROUTINES)
+
+#include <cstddef>
+#include <eels/expected.h>
+#include <benchmarks/benchmark.h>
+
+// An error raised at the bottom of a call stack of a given depth and propagated to its top,
+// with coroutines awaiting each level, with manual checks and with exceptions.
+// Every level hands the value it got to 'do_not_optimize', so that no version can fold the recursion away.
+
+namespace {
+
+typedef eels::expected<int, int> result;
+
+class failure
+{
+public:
+    explicit failure(int code) : code(code) { }
+    int code;
+};
+
+result leaf(int input)
+{
+    return input < 0 ? result(eels::unexpected, input) : result(input);
+}
+
+result manual(int depth, int input)
+{
+    if(depth == 0)
+        return leaf(input);
+    const result r = manual(depth - 1, input);
+    if(!r)
+        return eels::make_unexpected(r.error());
+    eels::benchmarks::do_not_optimize(*r);
+    return *r + 1;
+}
+
+result coroutine(int depth, int input)
+{
+    if(depth == 0)
+        co_return leaf(input);
+    const int value = co_await coroutine(depth - 1, input);
+    eels::benchmarks::do_not_optimize(value);
+    co_return value + 1;
+}
+
+int throwing(int depth, int input)
+{
+    if(depth == 0)
+    {
+        if(input < 0)
+            throw failure(input);
+        return input;
+    }
+    const int value = throwing(depth - 1, input);
+    eels::benchmarks::do_not_optimize(value);
+    return value + 1;
+}
+
+// every other call fails when 'FailV' is set
+template<int DepthV, bool FailV>
+void propagate_manual(std::size_t iterations)
+{
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const result r = manual(DepthV, FailV && (i & 1) ? -1 : static_cast<int>(i & 0xFF));
+        eels::benchmarks::do_not_optimize(r);
+    }
+}
+
+template<int DepthV, bool FailV>
+void propagate_coroutine(std::size_t iterations)
+{
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const result r = coroutine(DepthV, FailV && (i & 1) ? -1 : static_cast<int>(i & 0xFF));
+        eels::benchmarks::do_not_optimize(r);
+    }
+}
+
+template<int DepthV, bool FailV>
+void propagate_exceptions(std::size_t iterations)
+{
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        int value;
+        try
+        {
+            value = throwing(DepthV, FailV && (i & 1) ? -1 : static_cast<int>(i & 0xFF));
+        }
+        catch(const failure& f)
+        {
+            value = f.code;
+        }
+        eels::benchmarks::do_not_optimize(value);
+    }
+}
+
+}
+
+EELS_BENCHMARK(coroutine_manual_depth_1_no_error) { propagate_manual<1, false>(iterations); }
+EELS_BENCHMARK(coroutine_await_depth_1_no_error) { propagate_coroutine<1, false>(iterations); }
+EELS_BENCHMARK(coroutine_exceptions_depth_1_no_error) { propagate_exceptions<1, false>(iterations); }
+EELS_BENCHMARK(coroutine_manual_depth_1_half_errors) { propagate_manual<1, true>(iterations); }
+EELS_BENCHMARK(coroutine_await_depth_1_half_errors) { propagate_coroutine<1, true>(iterations); }
+EELS_BENCHMARK(coroutine_exceptions_depth_1_half_errors) { propagate_exceptions<1, true>(iterations); }
+
+EELS_BENCHMARK(coroutine_manual_depth_8_no_error) { propagate_manual<8, false>(iterations); }
+EELS_BENCHMARK(coroutine_await_depth_8_no_error) { propagate_coroutine<8, false>(iterations); }
+EELS_BENCHMARK(coroutine_exceptions_depth_8_no_error) { propagate_exceptions<8, false>(iterations); }
+EELS_BENCHMARK(coroutine_manual_depth_8_half_errors) { propagate_manual<8, true>(iterations); }
+EELS_BENCHMARK(coroutine_await_depth_8_half_errors) { propagate_coroutine<8, true>(iterations); }
+EELS_BENCHMARK(coroutine_exceptions_depth_8_half_errors) { propagate_exceptions<8, true>(iterations); }
+
+EELS_BENCHMARK(coroutine_manual_depth_64_no_error) { propagate_manual<64, false>(iterations); }
+EELS_BENCHMARK(coroutine_await_depth_64_no_error) { propagate_coroutine<64, false>(iterations); }
+EELS_BENCHMARK(coroutine_exceptions_depth_64_no_error) { propagate_exceptions<64, false>(iterations); }
+EELS_BENCHMARK(coroutine_manual_depth_64_half_errors) { propagate_manual<64, true>(iterations); }
+EELS_BENCHMARK(coroutine_await_depth_64_half_errors) { propagate_coroutine<64, true>(iterations); }
+EELS_BENCHMARK(coroutine_exceptions_depth_64_half_errors) { propagate_exceptions<64, true>(iterations); }
+
+#endif // !defined(EELS_NO_CXX20_COROUTINES)
@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <vector>
+#include <eels/expected.h>
+#include <eels/expected_vector.h>
+#include <benchmarks/benchmark.h>
+
+// Scanning a batch of results stored as 'std::vector<expected>' against 'expected_vector'.
+
+namespace {
+
+const std::size_t batch_size = 1 << 20;
+
+typedef eels::expected<int, int> result;
+
+// a single error, at the end
+std::vector<result> make_results()
+{
+    std::vector<result> results;
+    results.reserve(batch_size);
+    for(std::size_t i = 0; i + 1 < batch_size; ++i)
+        results.push_back(result(static_cast<int>(i)));
+    results.push_back(result(eels::unexpected, 1));
+    return results;
+}
+
+eels::expected_vector<int, int> make_vector()
+{
+    const std::vector<result> results = make_results();
+    eels::expected_vector<int, int> v;
+    v.reserve(results.size());
+    for(std::vector<result>::const_iterator it = results.begin(); it != results.end(); ++it)
+        v.push_back(*it);
+    return v;
+}
+
+}
+
+EELS_BENCHMARK(scan_first_error_vector_of_expected)
+{
+    const std::vector<result> results = make_results();
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        std::size_t index = 0;
+        while(index != results.size() && results[index])
+            ++index;
+        eels::benchmarks::do_not_optimize(index);
+    }
+}
+
+EELS_BENCHMARK(scan_first_error_expected_vector)
+{
+    const eels::expected_vector<int, int> v = make_vector();
+    for(std::size_t i = 0; i < iterations; ++i)
+        eels::benchmarks::do_not_optimize(v.first_error());
+}
+
+EELS_BENCHMARK(scan_count_errors_vector_of_expected)
+{
+    const std::vector<result> results = make_results();
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        std::size_t count = 0;
+        for(std::vector<result>::const_iterator it = results.begin(); it != results.end(); ++it)
+            count += !*it;
+        eels::benchmarks::do_not_optimize(count);
+    }
+}
+
+EELS_BENCHMARK(scan_count_errors_expected_vector)
+{
+    const eels::expected_vector<int, int> v = make_vector();
+    for(std::size_t i = 0; i < iterations; ++i)
+        eels::benchmarks::do_not_optimize(v.count_errors(1, v.size()));
+}
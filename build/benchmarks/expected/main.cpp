@@ -0,0 +1,10 @@
+#include <benchmarks/benchmark.h>
+
+#if defined(_MSC_VER)
+const volatile void* volatile eels::benchmarks::sink = nullptr;
+#endif
+
+int main(int args_count, char* args[])
+{
+    return eels::benchmarks::run(args_count > 1 ? args[1] : nullptr);
+}
@@ -0,0 +1,140 @@
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include <eels/expected.h>
+#include <eels/parallel.h>
+#include <benchmarks/benchmark.h>
+
+// Scaling of 'parallel_collect' and 'parallel_transform_reduce' with the number of threads,
+// for several distributions of the failing elements, against a sequential loop.
+// Thread counts above the number of cores of the machine run on as many threads as it has.
+
+namespace {
+
+const std::size_t batch_size = 1 << 16;
+
+enum class distribution
+{
+    no_error,       // every element is valid
+    early_error,    // a single failing element, at 1% of the batch
+    late_error,     // a single failing element, at 99% of the batch
+    uniform_errors  // 1% of the elements fail, spread over the batch
+};
+
+// Inputs are rejected when negative.
+std::vector<int> make_inputs(distribution errors)
+{
+    std::vector<int> inputs(batch_size);
+    unsigned state = 12345;
+    for(std::size_t i = 0; i < batch_size; ++i)
+    {
+        state = state * 1103515245u + 12345u;
+        const bool failing = errors == distribution::early_error ? i == batch_size / 100
+            : errors == distribution::late_error ? i == batch_size - batch_size / 100
+            : errors == distribution::uniform_errors ? (state >> 16) % 100 == 0
+            : false;
+        inputs[i] = failing ? -1 : static_cast<int>((state >> 8) % 10000);
+    }
+    return inputs;
+}
+
+typedef eels::expected<unsigned, int> result;
+
+// a few hundred nanoseconds of work per element
+struct hash_input
+{
+    result operator()(int v) const
+    {
+        if(v < 0)
+            return result(eels::unexpected, v);
+        unsigned h = static_cast<unsigned>(v);
+        for(int i = 0; i < 256; ++i)
+            h = h * 2654435761u + 0x9E3779B9u;
+        return result(h);
+    }
+};
+
+eels::parallel_options make_options(std::size_t threads, eels::error_policy policy)
+{
+    eels::parallel_options options;
+    options.threads = threads;
+    options.policy = policy;
+    return options;
+}
+
+template<distribution ErrorsV>
+void sequential(std::size_t iterations)
+{
+    const std::vector<int> inputs = make_inputs(ErrorsV);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        eels::expected<std::vector<unsigned>, int> collected(eels::in_place);
+        collected->reserve(inputs.size());
+        for(std::vector<int>::const_iterator it = inputs.begin(); it != inputs.end(); ++it)
+        {
+            const result r = hash_input()(*it);
+            if(!r)
+            {
+                collected = eels::expected<std::vector<unsigned>, int>(eels::unexpected, r.error());
+                break;
+            }
+            collected->push_back(*r);
+        }
+        eels::benchmarks::do_not_optimize(collected);
+    }
+}
+
+template<distribution ErrorsV, std::size_t ThreadsV, eels::error_policy PolicyV>
+void collect(std::size_t iterations)
+{
+    const std::vector<int> inputs = make_inputs(ErrorsV);
+    const eels::parallel_options options = make_options(ThreadsV, PolicyV);
+    for(std::size_t i = 0; i < iterations; ++i)
+        eels::benchmarks::do_not_optimize(eels::parallel_collect(inputs.begin(), inputs.end(), hash_input(), options));
+}
+
+template<distribution ErrorsV, std::size_t ThreadsV>
+void reduce(std::size_t iterations)
+{
+    const std::vector<int> inputs = make_inputs(ErrorsV);
+    const eels::parallel_options options = make_options(ThreadsV, eels::error_policy::lowest_index);
+    for(std::size_t i = 0; i < iterations; ++i)
+        eels::benchmarks::do_not_optimize(eels::parallel_transform_reduce(inputs.begin(), inputs.end(), 0u, std::plus<unsigned>(), hash_input(), options));
+}
+
+const eels::error_policy lowest_index = eels::error_policy::lowest_index;
+const eels::error_policy any = eels::error_policy::any;
+
+}
+
+EELS_BENCHMARK(parallel_sequential_no_error) { sequential<distribution::no_error>(iterations); }
+EELS_BENCHMARK(parallel_collect_no_error_1_thread) { collect<distribution::no_error, 1, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_no_error_2_threads) { collect<distribution::no_error, 2, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_no_error_4_threads) { collect<distribution::no_error, 4, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_no_error_8_threads) { collect<distribution::no_error, 8, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_no_error_all_threads) { collect<distribution::no_error, 0, lowest_index>(iterations); }
+
+EELS_BENCHMARK(parallel_sequential_early_error) { sequential<distribution::early_error>(iterations); }
+EELS_BENCHMARK(parallel_collect_early_error_1_thread) { collect<distribution::early_error, 1, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_early_error_4_threads) { collect<distribution::early_error, 4, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_early_error_all_threads) { collect<distribution::early_error, 0, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_early_error_all_threads_any) { collect<distribution::early_error, 0, any>(iterations); }
+
+EELS_BENCHMARK(parallel_sequential_late_error) { sequential<distribution::late_error>(iterations); }
+EELS_BENCHMARK(parallel_collect_late_error_1_thread) { collect<distribution::late_error, 1, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_late_error_4_threads) { collect<distribution::late_error, 4, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_late_error_all_threads) { collect<distribution::late_error, 0, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_late_error_all_threads_any) { collect<distribution::late_error, 0, any>(iterations); }
+
+EELS_BENCHMARK(parallel_sequential_uniform_errors) { sequential<distribution::uniform_errors>(iterations); }
+EELS_BENCHMARK(parallel_collect_uniform_errors_1_thread) { collect<distribution::uniform_errors, 1, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_uniform_errors_4_threads) { collect<distribution::uniform_errors, 4, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_uniform_errors_all_threads) { collect<distribution::uniform_errors, 0, lowest_index>(iterations); }
+EELS_BENCHMARK(parallel_collect_uniform_errors_all_threads_any) { collect<distribution::uniform_errors, 0, any>(iterations); }
+
+EELS_BENCHMARK(parallel_reduce_no_error_1_thread) { reduce<distribution::no_error, 1>(iterations); }
+EELS_BENCHMARK(parallel_reduce_no_error_2_threads) { reduce<distribution::no_error, 2>(iterations); }
+EELS_BENCHMARK(parallel_reduce_no_error_4_threads) { reduce<distribution::no_error, 4>(iterations); }
+EELS_BENCHMARK(parallel_reduce_no_error_8_threads) { reduce<distribution::no_error, 8>(iterations); }
+EELS_BENCHMARK(parallel_reduce_no_error_all_threads) { reduce<distribution::no_error, 0>(iterations); }
+EELS_BENCHMARK(parallel_reduce_late_error_all_threads) { reduce<distribution::late_error, 0>(iterations); }
@@ -0,0 +1,112 @@
+#include <cstddef>
+#include <vector>
+#include <eels/expected.h>
+#include <benchmarks/benchmark.h>
+
+// A 5-stage validation chain over a batch of inputs, a given share of them being rejected by the first stage,
+// written as a fused pipeline, as eagerly chained member calls and with exceptions.
+
+namespace {
+
+const std::size_t batch_size = 1024;
+
+// Inputs are rejected by the first stage when negative.
+std::vector<int> make_inputs(unsigned errors_per_thousand)
+{
+    std::vector<int> inputs(batch_size);
+    unsigned state = 12345;
+    for(std::size_t i = 0; i < batch_size; ++i)
+    {
+        state = state * 1103515245u + 12345u;
+        const int value = static_cast<int>((state >> 8) % 10000);
+        inputs[i] = (state >> 16) % 1000 < errors_per_thousand ? -value - 1 : value;
+    }
+    return inputs;
+}
+
+typedef eels::expected<int, int> result;
+
+// function objects, as lambdas would be
+struct check_sign { result operator()(int v) const { return v < 0 ? result(eels::unexpected, 1) : result(v); } };
+struct scale { int operator()(int v) const { return v * 3; } };
+struct check_range { result operator()(int v) const { return v > 1000000 ? result(eels::unexpected, 2) : result(v); } };
+struct offset { int operator()(int v) const { return v + 7; } };
+struct decorate { int operator()(int e) const { return e + 1000; } };
+
+class failure
+{
+public:
+    explicit failure(int code) : code(code) { }
+    int code;
+};
+
+int throwing_check_sign(int v) { if(v < 0) throw failure(1); return v; }
+int throwing_check_range(int v) { if(v > 1000000) throw failure(2); return v; }
+
+template<unsigned ErrorsPerThousandV>
+void fused(std::size_t iterations)
+{
+    const std::vector<int> inputs = make_inputs(ErrorsPerThousandV);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        int sum = 0;
+        for(std::vector<int>::const_iterator it = inputs.begin(); it != inputs.end(); ++it)
+        {
+            const result r = result(*it) | eels::and_then(check_sign()) | eels::map(scale()) | eels::and_then(check_range()) | eels::map(offset()) | eels::map_error(decorate());
+            sum += r ? *r : r.error();
+        }
+        eels::benchmarks::do_not_optimize(sum);
+    }
+}
+
+template<unsigned ErrorsPerThousandV>
+void eager(std::size_t iterations)
+{
+    const std::vector<int> inputs = make_inputs(ErrorsPerThousandV);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        int sum = 0;
+        for(std::vector<int>::const_iterator it = inputs.begin(); it != inputs.end(); ++it)
+        {
+            const result r = result(*it).and_then(check_sign()).map(scale()).and_then(check_range()).map(offset()).map_error(decorate());
+            sum += r ? *r : r.error();
+        }
+        eels::benchmarks::do_not_optimize(sum);
+    }
+}
+
+template<unsigned ErrorsPerThousandV>
+void exceptions(std::size_t iterations)
+{
+    const std::vector<int> inputs = make_inputs(ErrorsPerThousandV);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        int sum = 0;
+        for(std::vector<int>::const_iterator it = inputs.begin(); it != inputs.end(); ++it)
+        {
+            try
+            {
+                sum += offset()(throwing_check_range(scale()(throwing_check_sign(*it))));
+            }
+            catch(const failure& f)
+            {
+                sum += decorate()(f.code);
+            }
+        }
+        eels::benchmarks::do_not_optimize(sum);
+    }
+}
+
+}
+
+EELS_BENCHMARK(pipeline_fused_no_error) { fused<0>(iterations); }
+EELS_BENCHMARK(pipeline_eager_no_error) { eager<0>(iterations); }
+EELS_BENCHMARK(pipeline_exceptions_no_error) { exceptions<0>(iterations); }
+
+EELS_BENCHMARK(pipeline_fused_1_percent_errors) { fused<10>(iterations); }
+EELS_BENCHMARK(pipeline_eager_1_percent_errors) { eager<10>(iterations); }
+EELS_BENCHMARK(pipeline_exceptions_1_percent_errors) { exceptions<10>(iterations); }
+
+EELS_BENCHMARK(pipeline_fused_50_percent_errors) { fused<500>(iterations); }
+EELS_BENCHMARK(pipeline_eager_50_percent_errors) { eager<500>(iterations); }
+EELS_BENCHMARK(pipeline_exceptions_50_percent_errors) { exceptions<500>(iterations); }
@@ -0,0 +1,67 @@
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <eels/expected.h>
+#include <benchmarks/benchmark.h>
+
+// Failures propagated through a few calls with 'status', 'std::error_code' and 'std::string' as error types.
+
+namespace {
+
+const int depth = 8;
+
+template<typename ErrorT>
+class errors;
+
+template<>
+class errors<eels::status>
+{
+public:
+    static eels::status make() { return eels::status(eels::generic_status_domain, 22, "while parsing the request"); }
+};
+
+class packed_status
+{
+public:
+    static eels::status make() { return eels::status(eels::generic_status_domain, 22); }
+};
+
+template<>
+class errors<std::error_code>
+{
+public:
+    static std::error_code make() { return std::error_code(22, std::generic_category()); }
+};
+
+template<>
+class errors<std::string>
+{
+public:
+    static std::string make() { return "invalid argument: while parsing the request"; }
+};
+
+template<typename ErrorT, typename FactoryT>
+eels::expected<int, ErrorT> propagate(int level, int input)
+{
+    if(level == 0)
+        return input < 0 ? eels::expected<int, ErrorT>(eels::unexpected, FactoryT::make()) : eels::expected<int, ErrorT>(input);
+    eels::expected<int, ErrorT> r = propagate<ErrorT, FactoryT>(level - 1, input);
+    if(!r)
+        return r;
+    return *r + 1;
+}
+
+// every other call fails
+template<typename ErrorT, typename FactoryT = errors<ErrorT> >
+void failures(std::size_t iterations)
+{
+    for(std::size_t i = 0; i < iterations; ++i)
+        eels::benchmarks::do_not_optimize(propagate<ErrorT, FactoryT>(depth, i & 1 ? -1 : static_cast<int>(i & 0xFF)));
+}
+
+}
+
+EELS_BENCHMARK(status_propagate_status) { failures<eels::status>(iterations); }
+EELS_BENCHMARK(status_propagate_packed_status) { failures<eels::status, packed_status>(iterations); }
+EELS_BENCHMARK(status_propagate_error_code) { failures<std::error_code>(iterations); }
+EELS_BENCHMARK(status_propagate_string) { failures<std::string>(iterations); }
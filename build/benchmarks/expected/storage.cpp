@@ -0,0 +1,171 @@
+#include <cstddef>
+#include <type_traits>
+#include <eels/expected.h>
+#include <benchmarks/benchmark.h>
+
+// Construction, assignment and propagation of expected objects for each storage layout,
+// next to the same propagation with exceptions and with raw error codes.
+// Build with EELS_EXPECTED_INSTRUMENT to also see what each iteration does.
+
+namespace {
+
+const int depth = 8;
+
+// Trivial alternatives, copied as plain bytes.
+typedef eels::expected<int, int> trivial_merged;
+
+// A user-provided copy forces the storage layers to copy, a noexcept move keeps the merged buffer.
+class nontrivial
+{
+public:
+    nontrivial(int v) : value(v) { }
+    nontrivial(const nontrivial& other) : value(other.value) { }
+    nontrivial(nontrivial&& other) EELS_NOEXCEPT_IF(true) : value(other.value) { }
+    nontrivial& operator=(const nontrivial& other) { value = other.value; return *this; }
+    nontrivial& operator=(nontrivial&& other) EELS_NOEXCEPT_IF(true) { value = other.value; return *this; }
+    ~nontrivial() { }
+
+    int value;
+};
+
+// Moves that may throw on both sides leave no alternative to separate buffers.
+class throwing_move
+{
+public:
+    throwing_move(int v) : value(v) { }
+    throwing_move(const throwing_move& other) : value(other.value) { }
+    throwing_move(throwing_move&& other) EELS_NOEXCEPT_IF(false) : value(other.value) { }
+    throwing_move& operator=(const throwing_move& other) { value = other.value; return *this; }
+    throwing_move& operator=(throwing_move&& other) EELS_NOEXCEPT_IF(false) { value = other.value; return *this; }
+    ~throwing_move() { }
+
+    int value;
+};
+
+typedef eels::expected<nontrivial, int> nontrivial_merged;
+typedef eels::expected<throwing_move, throwing_move> nontrivial_independent;
+
+static_assert(std::is_same<eels::detail::buffer_selector<int, int>::type, eels::detail::merged_buffer<int, int> >::value, "");
+static_assert(std::is_same<eels::detail::buffer_selector<nontrivial, int>::type, eels::detail::merged_buffer<nontrivial, int> >::value, "");
+static_assert(std::is_same<eels::detail::buffer_selector<throwing_move, throwing_move>::type, eels::detail::independent_buffer<throwing_move, throwing_move> >::value, "");
+
+int value_of(int v) { return v; }
+int value_of(const nontrivial& v) { return v.value; }
+int value_of(const throwing_move& v) { return v.value; }
+
+// every other object holds an error
+template<typename ExpectedT>
+void construct(std::size_t iterations)
+{
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const int input = static_cast<int>(i & 0xFF);
+        ExpectedT e = i & 1 ? ExpectedT(eels::unexpected, input) : ExpectedT(eels::in_place, input);
+        eels::benchmarks::do_not_optimize(e);
+    }
+}
+
+// every assignment switches between a value and an error
+template<typename ExpectedT>
+void assign(std::size_t iterations)
+{
+    const ExpectedT valid(eels::in_place, 1);
+    const ExpectedT invalid(eels::unexpected, 2);
+    ExpectedT e(valid);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        e = i & 1 ? valid : invalid;
+        eels::benchmarks::do_not_optimize(e);
+    }
+}
+
+template<typename ExpectedT>
+ExpectedT propagate_expected(int level, int input)
+{
+    if(level == 0)
+        return input < 0 ? ExpectedT(eels::unexpected, input) : ExpectedT(eels::in_place, input);
+    ExpectedT r = propagate_expected<ExpectedT>(level - 1, input);
+    if(!r)
+        return r;
+    return ExpectedT(eels::in_place, value_of(*r) + 1);
+}
+
+// every other call fails
+template<typename ExpectedT>
+void propagate(std::size_t iterations)
+{
+    for(std::size_t i = 0; i < iterations; ++i)
+        eels::benchmarks::do_not_optimize(propagate_expected<ExpectedT>(depth, i & 1 ? -1 : static_cast<int>(i & 0xFF)));
+}
+
+int propagate_exception(int level, int input)
+{
+    if(level == 0)
+    {
+        if(input < 0)
+            throw input;
+        return input;
+    }
+    return propagate_exception(level - 1, input) + 1;
+}
+
+void propagate_exceptions(std::size_t iterations)
+{
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        int result;
+        try
+        {
+            result = propagate_exception(depth, i & 1 ? -1 : static_cast<int>(i & 0xFF));
+        }
+        catch(int error)
+        {
+            result = error;
+        }
+        eels::benchmarks::do_not_optimize(result);
+    }
+}
+
+// returns 0 on success, the value through 'output'
+int propagate_error_code(int level, int input, int& output)
+{
+    if(level == 0)
+    {
+        if(input < 0)
+            return input;
+        output = input;
+        return 0;
+    }
+    const int error = propagate_error_code(level - 1, input, output);
+    if(error)
+        return error;
+    ++output;
+    return 0;
+}
+
+void propagate_error_codes(std::size_t iterations)
+{
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        int output = 0;
+        const int error = propagate_error_code(depth, i & 1 ? -1 : static_cast<int>(i & 0xFF), output);
+        eels::benchmarks::do_not_optimize(error);
+        eels::benchmarks::do_not_optimize(output);
+    }
+}
+
+}
+
+EELS_BENCHMARK(storage_construct_trivial_merged) { construct<trivial_merged>(iterations); }
+EELS_BENCHMARK(storage_construct_nontrivial_merged) { construct<nontrivial_merged>(iterations); }
+EELS_BENCHMARK(storage_construct_nontrivial_independent) { construct<nontrivial_independent>(iterations); }
+
+EELS_BENCHMARK(storage_assign_trivial_merged) { assign<trivial_merged>(iterations); }
+EELS_BENCHMARK(storage_assign_nontrivial_merged) { assign<nontrivial_merged>(iterations); }
+EELS_BENCHMARK(storage_assign_nontrivial_independent) { assign<nontrivial_independent>(iterations); }
+
+EELS_BENCHMARK(storage_propagate_trivial_merged) { propagate<trivial_merged>(iterations); }
+EELS_BENCHMARK(storage_propagate_nontrivial_merged) { propagate<nontrivial_merged>(iterations); }
+EELS_BENCHMARK(storage_propagate_nontrivial_independent) { propagate<nontrivial_independent>(iterations); }
+EELS_BENCHMARK(storage_propagate_exceptions) { propagate_exceptions(iterations); }
+EELS_BENCHMARK(storage_propagate_error_codes) { propagate_error_codes(iterations); }
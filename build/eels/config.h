@@ -13,6 +13,8 @@
 #define EELS_NO_CXX11_CONSTEXPR
 #define EELS_NO_CXX11_NOEXCEPT
 #define EELS_NO_CXX11_REF_QUALIFIERS
+#define EELS_NO_CXX11_DEFAULTED_MOVE
+#define EELS_NO_CXX11_THREAD_LOCAL
 
 #endif // _MSC_VER <= 1800
 #endif // _MSC_VER <= 1900
@@ -39,4 +41,50 @@
 #  define EELS_NOEXCEPT_IF(...) noexcept((__VA_ARGS__))
 #endif
 
+#if defined(EELS_NO_CXX11_THREAD_LOCAL)
+#  define EELS_CXX11_THREAD_LOCAL __declspec(thread)
+#else
+#  define EELS_CXX11_THREAD_LOCAL thread_local
+#endif
+
+#if defined(_MSC_VER) && _MSC_VER <= 1800
+#  define EELS_IS_FINAL(T) __is_sealed(T)
+#else
+#  define EELS_IS_FINAL(T) __is_final(T)
+#endif
+
+// C++20 coroutines, which let functions returning an 'expected' propagate errors with 'co_await'.
+// The result of such a coroutine is only known once the conversion of its return object is delayed until it returns,
+// which the standard leaves unspecified (CWG 2563): they are only enabled with compilers known to delay it,
+// GCC, Visual C++ and Clang since 17 (Apple Clang since 16).
+#if !defined(__cpp_impl_coroutine) || __cpp_impl_coroutine < 201902L
+#  define EELS_NO_CXX20_COROUTINES
+#elif defined(__clang__)
+#  if (defined(__apple_build_version__) && __clang_major__ < 16) || (!defined(__apple_build_version__) && __clang_major__ < 17)
+#    define EELS_NO_CXX20_COROUTINES
+#  endif
+#elif !defined(__GNUC__) && !defined(_MSC_VER)
+#  define EELS_NO_CXX20_COROUTINES
+#endif
+
+// SIMD instruction sets enabled by the compiler options, define EELS_NO_SIMD to only use scalar code
+#if !defined(EELS_NO_SIMD)
+#  if defined(__AVX2__)
+#    define EELS_HAS_AVX2
+#  endif
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define EELS_HAS_SSE2
+#  endif
+#endif
+
+// Parallel algorithms run on the library's thread pool, define EELS_USE_PARALLEL_ALGORITHMS to run them
+// on the standard execution policies instead, which may require linking a backend such as TBB
+#if defined(EELS_USE_PARALLEL_ALGORITHMS) && !(__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#  error "EELS_USE_PARALLEL_ALGORITHMS requires C++17."
+#endif
+
+// Define EELS_EXPECTED_INSTRUMENT to count, per thread, what expected objects do: constructions, switches between
+// a value and an error, copies and moves, read with 'expected_counters_snapshot'; without it the counting compiles to nothing.
+// Instrumented builds never make 'expected' trivially copyable, which changes its ABI: define it for the whole program or not at all
+
 #endif // EELS_CONFIG_H_
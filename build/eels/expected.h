@@ -1,6 +1,9 @@
 #ifndef EELS_EXPECTED_H_
 #define EELS_EXPECTED_H_
 
+#include <eels/expected/coroutine.h>
 #include <eels/expected/expected.h>
+#include <eels/expected/instrumentation.h>
+#include <eels/expected/pipeline.h>
 
 #endif // EELS_EXPECTED_H_
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef EELS_EXPECTED_COROUTINE_H_
+#define EELS_EXPECTED_COROUTINE_H_
+
+#include <eels/config.h>
+
+#if !defined(EELS_NO_CXX20_COROUTINES)
+
+#include <coroutine>
+#include <eels/expected/expected.h>
+#include <eels/expected/detail/coroutine.h>
+
+// A function returning an 'expected' can be a coroutine:
+//  - 'co_await' on an 'expected' gives its value, or completes the coroutine with its error right away,
+//  - 'co_return' takes a value, an 'expected' or a factory such as 'make_unexpected'.
+// The coroutine runs to completion before returning, its frame comes from a per-thread stack of frames.
+template<typename ValueT, typename ErrorT, typename... ArgsT>
+struct std::coroutine_traits<eels::expected<ValueT, ErrorT>, ArgsT...>
+{
+    typedef eels::detail::expected_promise<ValueT, ErrorT> promise_type;
+};
+
+#endif // !defined(EELS_NO_CXX20_COROUTINES)
+
+#endif // EELS_EXPECTED_COROUTINE_H_
@@ -0,0 +1,175 @@
+#ifndef EELS_EXPECTED_DETAIL_BITSET_H_
+#define EELS_EXPECTED_DETAIL_BITSET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <eels/config.h>
+
+#if defined(EELS_HAS_AVX2) || defined(EELS_HAS_SSE2)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 { namespace detail {
+#else
+namespace eels { inline namespace expected_v1 { namespace detail {
+#endif
+
+// Scans over a packed bitset made of 64-bit words, bit 'i' being bit 'i % 64' of word 'i / 64'.
+
+static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t bits_per_word = 64;
+static EELS_CXX11_CONSTEXPR_OR_CONST std::uint64_t all_bits = ~std::uint64_t(0);
+
+inline std::size_t popcount(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<std::size_t>(__builtin_popcountll(word));
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(EELS_HAS_AVX2)
+	return static_cast<std::size_t>(__popcnt64(word));
+#else
+	word = word - ((word >> 1) & 0x5555555555555555ull);
+	word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return static_cast<std::size_t>((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// 'word' must not be zero.
+inline std::size_t count_trailing_zeros(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<std::size_t>(__builtin_ctzll(word));
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if(_BitScanForward(&index, static_cast<unsigned long>(word)))
+		return index;
+	_BitScanForward(&index, static_cast<unsigned long>(word >> 32));
+	return index + 32;
+#else
+	std::size_t count = 0;
+	while(!(word & 1))
+	{
+		word >>= 1;
+		++count;
+	}
+	return count;
+#endif
+}
+
+// Bits [0, count) of a word, 'count' being in [1, 64].
+inline std::uint64_t low_bits(std::size_t count)
+{
+	return all_bits >> (bits_per_word - count);
+}
+
+// Bits [first, 64) of a word, 'first' being in [0, 63].
+inline std::uint64_t high_bits(std::size_t first)
+{
+	return all_bits << first;
+}
+
+// Number of set bits in the words [first, last).
+inline std::size_t count_word_ones(const std::uint64_t* words, std::size_t first, std::size_t last)
+{
+	std::size_t count = 0;
+#if defined(EELS_HAS_AVX2)
+	// nibble lookup, summed per 64-bit lane
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+	__m256i total = _mm256_setzero_si256();
+	for(; first + 4 <= last; first += 4)
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + first));
+		const __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(block, low_nibbles));
+		const __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(block, 4), low_nibbles));
+		total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+	}
+	std::uint64_t lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+	count += static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+#endif
+	for(; first < last; ++first)
+		count += popcount(words[first]);
+	return count;
+}
+
+// First word in [first, last) with a clear bit, or 'last'.
+inline std::size_t find_word_with_zero(const std::uint64_t* words, std::size_t first, std::size_t last)
+{
+#if defined(EELS_HAS_AVX2)
+	const __m256i ones = _mm256_set1_epi64x(-1);
+	for(; first + 4 <= last; first += 4)
+	{
+		if(!_mm256_testc_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + first)), ones))
+			break;
+	}
+#elif defined(EELS_HAS_SSE2)
+	const __m128i ones = _mm_set1_epi32(-1);
+	for(; first + 2 <= last; first += 2)
+	{
+		if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words + first)), ones)) != 0xFFFF)
+			break;
+	}
+#endif
+	for(; first < last; ++first)
+	{
+		if(words[first] != all_bits)
+			break;
+	}
+	return first;
+}
+
+// Number of set bits in [first, last).
+inline std::size_t count_ones(const std::uint64_t* words, std::size_t first, std::size_t last)
+{
+	if(first >= last)
+		return 0;
+
+	const std::size_t first_word = first / bits_per_word;
+	const std::size_t last_word = (last - 1) / bits_per_word;
+	const std::uint64_t first_mask = high_bits(first % bits_per_word);
+	const std::uint64_t last_mask = low_bits((last - 1) % bits_per_word + 1);
+	if(first_word == last_word)
+		return popcount(words[first_word] & first_mask & last_mask);
+
+	return popcount(words[first_word] & first_mask)
+		+ count_word_ones(words, first_word + 1, last_word)
+		+ popcount(words[last_word] & last_mask);
+}
+
+// Index of the first clear bit in [first, last), or 'last'.
+inline std::size_t find_first_zero(const std::uint64_t* words, std::size_t first, std::size_t last)
+{
+	if(first >= last)
+		return last;
+
+	const std::size_t first_word = first / bits_per_word;
+	const std::size_t last_word = (last - 1) / bits_per_word;
+	const std::uint64_t last_mask = low_bits((last - 1) % bits_per_word + 1);
+
+	std::uint64_t zeros = ~words[first_word] & high_bits(first % bits_per_word);
+	if(first_word == last_word)
+		zeros &= last_mask;
+	if(zeros)
+		return first_word * bits_per_word + count_trailing_zeros(zeros);
+	if(first_word == last_word)
+		return last;
+
+	const std::size_t word = find_word_with_zero(words, first_word + 1, last_word);
+	if(word != last_word)
+		return word * bits_per_word + count_trailing_zeros(~words[word]);
+
+	zeros = ~words[last_word] & last_mask;
+	return zeros ? last_word * bits_per_word + count_trailing_zeros(zeros) : last;
+}
+
+} } }
+
+#endif // EELS_EXPECTED_DETAIL_BITSET_H_
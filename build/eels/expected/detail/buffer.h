@@ -1,8 +1,14 @@
 #ifndef EELS_EXPECTED_DETAIL_BUFFER_H_
 #define EELS_EXPECTED_DETAIL_BUFFER_H_
 
+#include <cassert>
+#include <cstddef>
 #include <type_traits>
 #include <utility>
+#include <eels/config.h>
+#include <eels/expected/niche.h>
+#include <eels/expected/detail/instrumentation.h>
+#include <eels/expected/detail/niche.h>
 
 #if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
 namespace eels { namespace expected_v1 { namespace detail {
@@ -13,65 +19,208 @@ namespace eels { inline namespace expected_v1 { namespace detail {
 class value_from_buffer_t {};
 class error_from_buffer_t {};
 
+// Counts a completed switch to the alternative of the tag.
+inline void count_switch(value_from_buffer_t) { EELS_EXPECTED_COUNT(error_to_value_counter); }
+inline void count_switch(error_from_buffer_t) { EELS_EXPECTED_COUNT(value_to_error_counter); }
+
+// When both alternatives share the same bytes, the old one has to be destroyed before the new one is constructed.
+// Switching still gives the strong guarantee:
+//  - nothrow_switch_t: constructing the new alternative cannot throw,
+//  - target_aside_switch_t: the new alternative is built aside then moved in, which cannot throw,
+//  - source_aside_switch_t: the old alternative is moved aside and put back if the construction throws.
+class nothrow_switch_t {};
+class target_aside_switch_t {};
+class source_aside_switch_t {};
+
+template<typename FromT, typename ToT, typename... ArgsT>
+class overlapping_switch_selector
+{
+public:
+	typedef typename std::conditional<
+						std::is_nothrow_constructible<typename ToT::value_type, ArgsT...>::value,
+					nothrow_switch_t,
+					typename std::conditional<
+								std::is_nothrow_move_constructible<typename ToT::value_type>::value,
+							target_aside_switch_t,
+							source_aside_switch_t
+					>::type
+	>::type type;
+};
+
+template<typename BufferT, typename FromT, typename ToT, typename... ArgsT>
+void switch_overlapping(BufferT& buffer, FromT& from, ToT& to, nothrow_switch_t, ArgsT&&... args)
+{
+	from.destruct();
+	to.construct(std::forward<ArgsT>(args)...);
+	buffer.select(typename ToT::tag_type());
+}
+
+template<typename BufferT, typename FromT, typename ToT, typename... ArgsT>
+void switch_overlapping(BufferT& buffer, FromT& from, ToT& to, target_aside_switch_t, ArgsT&&... args)
+{
+	typename ToT::value_type target(std::forward<ArgsT>(args)...);
+	from.destruct();
+	to.construct(std::move(target));
+	buffer.select(typename ToT::tag_type());
+}
+
+template<typename BufferT, typename FromT, typename ToT, typename... ArgsT>
+void switch_overlapping(BufferT& buffer, FromT& from, ToT& to, source_aside_switch_t, ArgsT&&... args)
+{
+	static_assert(std::is_nothrow_move_constructible<typename FromT::value_type>::value, "Overlapping alternatives require one of them to be nothrow move constructible.");
+
+	typename FromT::value_type source(std::move(from.get()));
+	from.destruct();
+	try
+	{
+		to.construct(std::forward<ArgsT>(args)...);
+	}
+	catch(...)
+	{
+		from.construct(std::move(source));
+		buffer.select(typename FromT::tag_type());
+		throw;
+	}
+	buffer.select(typename ToT::tag_type());
+}
+
 template<typename ValueT, typename ErrorT>
 class merged_buffer
 {
 public:
 	typedef ValueT value_type;
 	typedef ErrorT error_type;
+	typedef value_type value_slot_type;
+	typedef error_type error_slot_type;
+
+	void* get(value_from_buffer_t) { return &data_; }
+	const void* get(value_from_buffer_t) const { return &data_; }
 
-	template<typename T> void* get();
-	template<typename T> const void* get() const;
+	void* get(error_from_buffer_t) { return &data_; }
+	const void* get(error_from_buffer_t) const { return &data_; }
 
-	template<> void* get<value_from_buffer_t>() { return &data_; }
-	template<> const void* get<value_from_buffer_t>() const { return &data_; }
+	bool valid() const { return is_valid_; }
+	void select(value_from_buffer_t) { is_valid_ = true; }
+	void select(error_from_buffer_t) { is_valid_ = false; }
 
-	template<> void* get<error_from_buffer_t>() { return &data_; }
-	template<> const void* get<error_from_buffer_t>() const { return &data_; }
+	template<typename FromT, typename ToT, typename... ArgsT>
+	void switch_fromto(FromT& from, ToT& to, ArgsT&&... args)
+	{
+		switch_overlapping(*this, from, to, typename overlapping_switch_selector<FromT, ToT, ArgsT...>::type(), std::forward<ArgsT>(args)...);
+		count_switch(typename ToT::tag_type());
+	}
 
-	template<typename FromT, typename ToT>
-	void switch_fromto(FromT& from, ToT& to, const typename ToT::value_type& val)
-	{ from.destruct(); to.construct(val); }
-	template<typename FromT, typename ToT>
-	void switch_fromto(FromT& from, ToT& to, typename ToT::value_type&& val)
-	{ from.destruct(); to.construct(std::move(val)); }
-    template<typename FromT, typename ToT, typename... ArgsT>
-    void switch_fromto(FromT& from, ToT& to, ArgsT&&... args)
-    { from.destruct(); to.construct(std::forward<ArgsT>(args)...); }
 private:
-    static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t size = sizeof(value_type) > sizeof(error_type) ? sizeof(value_type) : sizeof(error_type);
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t size = sizeof(value_type) > sizeof(error_type) ? sizeof(value_type) : sizeof(error_type);
 	typename std::aligned_union<size, value_type, error_type >::type data_;
+	bool is_valid_;
 };
 
+// Only used when neither alternative can be moved without throwing:
+// the new alternative is constructed before the old one is destroyed.
 template<typename ValueT, typename ErrorT>
 class independent_buffer
 {
 public:
 	typedef ValueT value_type;
 	typedef ErrorT error_type;
+	typedef value_type value_slot_type;
+	typedef error_type error_slot_type;
 
-	template<typename T> void* get();
-	template<typename T> const void* get() const;
+	void* get(value_from_buffer_t) { return &value_data_; }
+	const void* get(value_from_buffer_t) const { return &value_data_; }
 
-	template<> void* get<value_from_buffer_t>() { return &value_data_; }
-	template<> const void* get<value_from_buffer_t>() const { return &value_data_; }
+	void* get(error_from_buffer_t) { return &error_data_; }
+	const void* get(error_from_buffer_t) const { return &error_data_; }
 
-	template<> void* get<error_from_buffer_t>() { return &error_data_; }
-	template<> const void* get<error_from_buffer_t>() const { return &error_data_; }
+	bool valid() const { return is_valid_; }
+	void select(value_from_buffer_t) { is_valid_ = true; }
+	void select(error_from_buffer_t) { is_valid_ = false; }
 
-	template<typename FromT, typename ToT>
-	void switch_fromto(FromT& from, ToT& to, const typename ToT::value_type& val)
-	{ to.construct(val); from.destruct(); }
-	template<typename FromT, typename ToT>
-	void switch_fromto(FromT& from, ToT& to, typename ToT::value_type&& val)
-	{ to.construct(std::move(val)); from.destruct(); }
-    template<typename FromT, typename ToT, typename... ArgsT>
-    void switch_fromto(FromT& from, ToT& to, ArgsT&&... args)
-    { to.construct(std::forward<ArgsT>(args)...); from.destruct(); }
+	template<typename FromT, typename ToT, typename... ArgsT>
+	void switch_fromto(FromT& from, ToT& to, ArgsT&&... args)
+	{
+		to.construct(std::forward<ArgsT>(args)...);
+		from.destruct();
+		select(typename ToT::tag_type());
+		count_switch(typename ToT::tag_type());
+	}
 
 private:
 	typename std::aligned_storage<sizeof(value_type), std::alignment_of<value_type>::value>::type value_data_;
 	typename std::aligned_storage<sizeof(error_type), std::alignment_of<error_type>::value>::type error_data_;
+	bool is_valid_;
+};
+
+// Where 'GuestT' can live inside the bytes of 'HostT' without touching its niche.
+// Empty guests take no room.
+template<typename HostT, typename GuestT, bool HasNicheV = niche_traits<HostT>::has_niche>
+class niche_layout
+{
+public:
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool value = false;
+};
+
+template<typename HostT, typename GuestT>
+class niche_layout<HostT, GuestT, true>
+{
+private:
+	typedef niche_traits<HostT> traits_type;
+
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t guest_size = std::is_empty<GuestT>::value ? 0 : sizeof(GuestT);
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t guest_alignment = std::alignment_of<GuestT>::value;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t niche_end = traits_type::offset + traits_type::size;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t after_niche = (niche_end + guest_alignment - 1) / guest_alignment * guest_alignment;
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool fits_before = guest_size <= traits_type::offset;
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool fits_after = after_niche + guest_size <= sizeof(HostT);
+
+public:
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool value = fits_before || fits_after;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t guest_offset = fits_before ? 0 : after_niche;
+};
+
+// Stores the state in a niche of the host alternative ('ValueHostsV' tells which one),
+// the other alternative living in the bytes the niche leaves free.
+template<typename ValueT, typename ErrorT, bool ValueHostsV>
+class niche_buffer
+{
+public:
+	typedef ValueT value_type;
+	typedef ErrorT error_type;
+
+private:
+	typedef typename std::conditional<ValueHostsV, value_type, error_type>::type host_type;
+	typedef typename std::conditional<ValueHostsV, error_type, value_type>::type guest_type;
+	typedef typename std::conditional<ValueHostsV, value_from_buffer_t, error_from_buffer_t>::type host_tag;
+	typedef typename std::conditional<ValueHostsV, error_from_buffer_t, value_from_buffer_t>::type guest_tag;
+	typedef niche_traits<host_type> traits_type;
+	typedef niche_layout<host_type, guest_type> layout_type;
+
+public:
+	typedef typename std::conditional<ValueHostsV, typename niche_slot<traits_type, value_type>::type, value_type>::type value_slot_type;
+	typedef typename std::conditional<ValueHostsV, error_type, typename niche_slot<traits_type, error_type>::type>::type error_slot_type;
+
+	void* get(host_tag) { return &data_; }
+	const void* get(host_tag) const { return &data_; }
+
+	void* get(guest_tag) { return reinterpret_cast<unsigned char*>(&data_) + layout_type::guest_offset; }
+	const void* get(guest_tag) const { return reinterpret_cast<const unsigned char*>(&data_) + layout_type::guest_offset; }
+
+	bool valid() const { return traits_type::test(&data_) != ValueHostsV; }
+	// called once the alternative is constructed: the host clears the niche itself, the guest needs it set
+	void select(host_tag) { assert(!traits_type::test(&data_)); }
+	void select(guest_tag) { traits_type::set(&data_); }
+
+	template<typename FromT, typename ToT, typename... ArgsT>
+	void switch_fromto(FromT& from, ToT& to, ArgsT&&... args)
+	{
+		switch_overlapping(*this, from, to, typename overlapping_switch_selector<FromT, ToT, ArgsT...>::type(), std::forward<ArgsT>(args)...);
+		count_switch(typename ToT::tag_type());
+	}
+
+private:
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t alignment = std::alignment_of<host_type>::value > std::alignment_of<guest_type>::value ? std::alignment_of<host_type>::value : std::alignment_of<guest_type>::value;
+	typename std::aligned_storage<sizeof(host_type), alignment>::type data_;
 };
 
 template<typename ValueT, typename ErrorT>
@@ -81,10 +230,17 @@ public:
 	typedef ValueT value_type;
 	typedef ErrorT error_type;
 	typedef typename std::conditional<
-						std::is_nothrow_copy_constructible<value_type>::value && std::is_nothrow_move_constructible<value_type>::value &&
-						std::is_nothrow_copy_constructible<error_type>::value && std::is_nothrow_move_constructible<error_type>::value,
-					merged_buffer<value_type, error_type>,
-					independent_buffer<value_type, error_type>
+						!(std::is_nothrow_move_constructible<value_type>::value || std::is_nothrow_move_constructible<error_type>::value),
+					independent_buffer<value_type, error_type>,
+					typename std::conditional<
+								niche_layout<value_type, error_type>::value,
+							niche_buffer<value_type, error_type, true>,
+							typename std::conditional<
+										niche_layout<error_type, value_type>::value,
+									niche_buffer<value_type, error_type, false>,
+									merged_buffer<value_type, error_type>
+							>::type
+					>::type
 	>::type type;
 };
 
@@ -0,0 +1,34 @@
+#ifndef EELS_EXPECTED_DETAIL_CALL_RESULT_H_
+#define EELS_EXPECTED_DETAIL_CALL_RESULT_H_
+
+#include <utility>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 { namespace detail {
+#else
+namespace eels { inline namespace expected_v1 { namespace detail {
+#endif
+
+template<typename T>
+class void_type
+{
+public:
+    typedef void type;
+};
+
+// Type returned by calling a 'FunctionT' with an 'ArgT', as 'std::result_of<FunctionT(ArgT)>' did before C++17 deprecated it.
+// Has no 'type' when the call is ill-formed.
+template<typename FunctionT, typename ArgT, typename EnableT = void>
+class call_result
+{ };
+
+template<typename FunctionT, typename ArgT>
+class call_result<FunctionT, ArgT, typename void_type<decltype(std::declval<FunctionT>()(std::declval<ArgT>()))>::type>
+{
+public:
+    typedef decltype(std::declval<FunctionT>()(std::declval<ArgT>())) type;
+};
+
+} } }
+
+#endif // EELS_EXPECTED_DETAIL_CALL_RESULT_H_
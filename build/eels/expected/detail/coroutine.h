@@ -0,0 +1,155 @@
+#ifndef EELS_EXPECTED_DETAIL_COROUTINE_H_
+#define EELS_EXPECTED_DETAIL_COROUTINE_H_
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <eels/config.h>
+#include <eels/expected/expected.h>
+#include <eels/expected/tags.h>
+#include <eels/expected/detail/frame_arena.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 { namespace detail {
+#else
+namespace eels { inline namespace expected_v1 { namespace detail {
+#endif
+
+template<typename ValueT, typename ErrorT>
+class expected_promise;
+
+// Object returned by the promise of a coroutine, converted to the 'expected' the coroutine returns once it is done.
+// The result is built here rather than in the promise: the coroutine frame is destroyed as soon as the coroutine completes.
+// This needs the compiler to convert the return object only once the coroutine returns to its caller, which the standard
+// leaves open (CWG 2563): config.h only enables coroutines with compilers known to do so, and any other one terminates.
+template<typename ValueT, typename ErrorT>
+class coroutine_result
+{
+public:
+    typedef expected<ValueT, ErrorT> expected_type;
+
+    explicit coroutine_result(expected_promise<ValueT, ErrorT>& promise)
+        : promise_(&promise), ready_(false)
+    {
+        promise.bind(*this);
+    }
+
+    coroutine_result(coroutine_result<ValueT, ErrorT>&& other)
+        : promise_(other.promise_), ready_(other.ready_)
+    {
+        if(ready_)
+            ::new(&result_) expected_type(std::move(other.result_));
+        else
+            promise_->bind(*this);
+    }
+
+    ~coroutine_result()
+    {
+        if(ready_)
+            result_.~expected_type();
+    }
+
+    operator expected_type()
+    {
+        // not an assertion: release builds would otherwise read a result that does not exist yet
+        if(!ready_)
+            std::terminate();
+        return std::move(result_);
+    }
+
+    template<typename... ArgsT>
+    void set(ArgsT&&... args)
+    {
+        assert(!ready_);
+        ::new(&result_) expected_type(std::forward<ArgsT>(args)...);
+        ready_ = true;
+    }
+
+private:
+    coroutine_result(const coroutine_result<ValueT, ErrorT>&) = delete;
+    coroutine_result<ValueT, ErrorT>& operator=(const coroutine_result<ValueT, ErrorT>&) = delete;
+
+private:
+    expected_promise<ValueT, ErrorT>* promise_;
+    union { expected_type result_; };
+    bool ready_;
+};
+
+// 'co_await' on an 'expected': resumes with its value, or completes the awaiting coroutine with its error and destroys it.
+template<typename ExpectedT>
+class expected_awaiter
+{
+public:
+    typedef typename std::remove_reference<ExpectedT>::type source_type;
+    // a reference to the value of an lvalue source, the value itself, moved, for an rvalue one
+    typedef typename std::conditional<std::is_lvalue_reference<ExpectedT>::value,
+        decltype(*std::declval<ExpectedT>()),
+        typename source_type::value_type>::type value_type;
+
+    explicit expected_awaiter(source_type& source) : source_(&source) { }
+
+    bool await_ready() const noexcept { return static_cast<bool>(*source_); }
+
+    template<typename PromiseT>
+    void await_suspend(std::coroutine_handle<PromiseT> coroutine)
+    {
+        coroutine.promise().return_error(std::forward<ExpectedT>(*source_).error());
+        coroutine.destroy();
+    }
+
+    value_type await_resume() const { return *std::forward<ExpectedT>(*source_); }
+
+private:
+    source_type* source_;
+};
+
+template<typename ValueT, typename ErrorT>
+class expected_promise
+{
+public:
+    typedef expected<ValueT, ErrorT> expected_type;
+
+    // frames never outlive the call creating them, see 'frame_arena'
+    static void* operator new(std::size_t size) { return frame_arena::local().allocate(size); }
+    static void operator delete(void* frame, std::size_t size) { frame_arena::local().deallocate(frame, size); }
+
+    expected_promise() : result_(nullptr) { }
+
+    coroutine_result<ValueT, ErrorT> get_return_object() { return coroutine_result<ValueT, ErrorT>(*this); }
+
+    // runs right away, and the frame goes away as soon as the coroutine is done
+    std::suspend_never initial_suspend() const noexcept { return std::suspend_never(); }
+    std::suspend_never final_suspend() const noexcept { return std::suspend_never(); }
+
+    // a value, an 'expected' or a factory such as 'make_unexpected'
+    template<typename ResultT>
+    void return_value(ResultT&& result) { result_->set(std::forward<ResultT>(result)); }
+
+    template<typename OtherErrorT>
+    void return_error(OtherErrorT&& err) { result_->set(unexpected, std::forward<OtherErrorT>(err)); }
+
+    // thrown from the call creating the coroutine, which destroys the frame
+    void unhandled_exception() { throw; }
+
+    template<typename OtherValueT, typename OtherErrorT>
+    expected_awaiter<expected<OtherValueT, OtherErrorT>&> await_transform(expected<OtherValueT, OtherErrorT>& source) { return expected_awaiter<expected<OtherValueT, OtherErrorT>&>(source); }
+
+    template<typename OtherValueT, typename OtherErrorT>
+    expected_awaiter<const expected<OtherValueT, OtherErrorT>&> await_transform(const expected<OtherValueT, OtherErrorT>& source) { return expected_awaiter<const expected<OtherValueT, OtherErrorT>&>(source); }
+
+    template<typename OtherValueT, typename OtherErrorT>
+    expected_awaiter<expected<OtherValueT, OtherErrorT>&&> await_transform(expected<OtherValueT, OtherErrorT>&& source) { return expected_awaiter<expected<OtherValueT, OtherErrorT>&&>(source); }
+
+    void bind(coroutine_result<ValueT, ErrorT>& result) { result_ = &result; }
+
+private:
+    coroutine_result<ValueT, ErrorT>* result_;
+};
+
+} } }
+
+#endif // EELS_EXPECTED_DETAIL_COROUTINE_H_
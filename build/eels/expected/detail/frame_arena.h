@@ -0,0 +1,78 @@
+#ifndef EELS_EXPECTED_DETAIL_FRAME_ARENA_H_
+#define EELS_EXPECTED_DETAIL_FRAME_ARENA_H_
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <eels/config.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 { namespace detail {
+#else
+namespace eels { inline namespace expected_v1 { namespace detail {
+#endif
+
+// Per-thread stack of coroutine frames.
+// The frame of a coroutine returning an 'expected' is destroyed before the call that created it returns,
+// so frames are freed in the reverse order of their allocation and can simply be pushed and popped.
+// Frames that do not fit fall back to the global allocation functions.
+class frame_arena
+{
+public:
+    static const std::size_t capacity = 64 * 1024;
+    static const std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static frame_arena& local()
+    {
+        thread_local frame_arena arena;
+        return arena;
+    }
+
+    frame_arena() : begin_(nullptr), top_(nullptr) { }
+    ~frame_arena() { ::operator delete(begin_); }
+
+    void* allocate(std::size_t size)
+    {
+        size = round_up(size);
+        if(!begin_)
+            top_ = begin_ = static_cast<char*>(::operator new(capacity));
+        if(static_cast<std::size_t>(begin_ + capacity - top_) < size)
+            return ::operator new(size);
+        void* frame = top_;
+        top_ += size;
+        return frame;
+    }
+
+    void deallocate(void* frame, std::size_t size)
+    {
+        char* const bytes = static_cast<char*>(frame);
+        if(!owns(bytes))
+        {
+            ::operator delete(frame);
+            return;
+        }
+        assert(bytes + round_up(size) == top_ && "coroutine frames should be freed in the reverse order of their allocation");
+        static_cast<void>(size);
+        top_ = bytes;
+    }
+
+private:
+    frame_arena(const frame_arena&);
+    frame_arena& operator=(const frame_arena&);
+
+    static std::size_t round_up(std::size_t size) { return (size + alignment - 1) / alignment * alignment; }
+
+    bool owns(const char* bytes) const
+    {
+        return begin_ && !std::less<const char*>()(bytes, begin_) && std::less<const char*>()(bytes, begin_ + capacity);
+    }
+
+private:
+    char* begin_;
+    char* top_;
+};
+
+} } }
+
+#endif // EELS_EXPECTED_DETAIL_FRAME_ARENA_H_
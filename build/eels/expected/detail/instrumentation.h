@@ -0,0 +1,155 @@
+#ifndef EELS_EXPECTED_DETAIL_INSTRUMENTATION_H_
+#define EELS_EXPECTED_DETAIL_INSTRUMENTATION_H_
+
+#include <eels/config.h>
+
+#if defined(EELS_EXPECTED_INSTRUMENT)
+#  if defined(EELS_NO_CXX11_THREAD_LOCAL)
+#    error "EELS_EXPECTED_INSTRUMENT requires thread_local."
+#  endif
+#  include <atomic>
+#  include <cstddef>
+#  include <cstdint>
+#  include <mutex>
+#  include <vector>
+#endif
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 { namespace detail {
+#else
+namespace eels { inline namespace expected_v1 { namespace detail {
+#endif
+
+enum counter_index
+{
+    construction_counter,
+    error_construction_counter,
+    value_to_error_counter,
+    error_to_value_counter,
+    copy_counter,
+    move_counter,
+    counter_count
+};
+
+// Without instrumentation, copies and moves of trivial alternatives are left to the compiler and cannot be counted:
+// instrumented builds always go through the storage layers that implement them.
+// This makes 'expected' of trivial types non trivially copyable, which changes how it is passed and returned:
+// every translation unit of a program must agree on EELS_EXPECTED_INSTRUMENT.
+#if defined(EELS_EXPECTED_INSTRUMENT)
+static EELS_CXX11_CONSTEXPR_OR_CONST bool allow_trivial_storage = false;
+#else
+static EELS_CXX11_CONSTEXPR_OR_CONST bool allow_trivial_storage = true;
+#endif
+
+#if defined(EELS_EXPECTED_INSTRUMENT)
+
+// Counters of a thread, written by that thread only, and read by whoever takes a snapshot.
+class counter_block
+{
+public:
+    counter_block()
+    {
+        for(std::size_t i = 0; i < counter_count; ++i)
+            counts[i].store(0, std::memory_order_relaxed);
+    }
+
+    // no read-modify-write needed with a single writer
+    void increment(counter_index index)
+    {
+        counts[index].store(counts[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::atomic<std::uint64_t> counts[counter_count];
+};
+
+// Blocks of the running threads, and the totals of the threads that exited.
+class counter_registry
+{
+public:
+    // never destroyed, threads may exit after static objects are gone
+    static counter_registry& instance()
+    {
+        static counter_registry* registry = new counter_registry();
+        return *registry;
+    }
+
+    void add(counter_block& block)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        blocks_.push_back(&block);
+    }
+
+    void remove(counter_block& block)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(std::size_t i = 0; i < counter_count; ++i)
+            retired_[i] += block.counts[i].load(std::memory_order_relaxed);
+        for(std::vector<counter_block*>::iterator it = blocks_.begin(); it != blocks_.end(); ++it)
+        {
+            if(*it == &block)
+            {
+                blocks_.erase(it);
+                break;
+            }
+        }
+    }
+
+    void sum(std::uint64_t (&totals)[counter_count])
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(std::size_t i = 0; i < counter_count; ++i)
+            totals[i] = retired_[i];
+        for(std::vector<counter_block*>::const_iterator it = blocks_.begin(); it != blocks_.end(); ++it)
+        {
+            for(std::size_t i = 0; i < counter_count; ++i)
+                totals[i] += (*it)->counts[i].load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    counter_registry()
+    {
+        for(std::size_t i = 0; i < counter_count; ++i)
+            retired_[i] = 0;
+    }
+
+    counter_registry(const counter_registry&);
+    counter_registry& operator=(const counter_registry&);
+
+private:
+    std::mutex mutex_;
+    std::vector<counter_block*> blocks_;
+    std::uint64_t retired_[counter_count];
+};
+
+class thread_counters
+{
+public:
+    thread_counters() { counter_registry::instance().add(block); }
+    ~thread_counters() { counter_registry::instance().remove(block); }
+
+    counter_block block;
+};
+
+inline counter_block& local_counters()
+{
+    static thread_local thread_counters counters;
+    return counters.block;
+}
+
+inline void count_event(counter_index index)
+{
+    local_counters().increment(index);
+}
+
+#endif // defined(EELS_EXPECTED_INSTRUMENT)
+
+} } }
+
+#if defined(EELS_EXPECTED_INSTRUMENT)
+#  define EELS_EXPECTED_COUNT(index) ::eels::expected_v1::detail::count_event(::eels::expected_v1::detail::index)
+#else
+#  define EELS_EXPECTED_COUNT(index) static_cast<void>(0)
+#endif
+
+#endif // EELS_EXPECTED_DETAIL_INSTRUMENTATION_H_
@@ -0,0 +1,103 @@
+#ifndef EELS_EXPECTED_DETAIL_NICHE_H_
+#define EELS_EXPECTED_DETAIL_NICHE_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <eels/config.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 { namespace detail {
+#else
+namespace eels { inline namespace expected_v1 { namespace detail {
+#endif
+
+// A class deriving from T may lay its own members out in T's tail padding (Itanium ABI, non-POD T).
+// 'tail_probe' measures how many of those bytes are available.
+template<typename T, std::size_t Count>
+class tail_probe
+	: public T
+{
+public:
+	unsigned char bytes_[Count];
+};
+
+template<typename T, std::size_t Count>
+class reusable_tail_impl
+	: public std::conditional<
+				sizeof(tail_probe<T, Count>) == sizeof(T),
+			std::integral_constant<std::size_t, Count>,
+			reusable_tail_impl<T, Count - 1>
+	>::type
+{ };
+
+template<typename T>
+class reusable_tail_impl<T, 0>
+	: public std::integral_constant<std::size_t, 0>
+{ };
+
+template<typename T, bool IsDerivableV = std::is_class<T>::value && !EELS_IS_FINAL(T)>
+class reusable_tail
+	: public std::integral_constant<std::size_t, 0>
+{ };
+
+template<typename T>
+class reusable_tail<T, true>
+	: public reusable_tail_impl<T, std::alignment_of<T>::value - 1>
+{ };
+
+// Object actually constructed in the storage when T's tail padding holds the niche.
+// The compiler never writes over 'state_' when copying or assigning the T base subobject.
+template<typename T>
+class tail_slot
+	: public T
+{
+public:
+	template<typename... ArgsT>
+	tail_slot(ArgsT&&... args) EELS_NOEXCEPT_IF((std::is_nothrow_constructible<T, ArgsT...>::value))
+		: T(std::forward<ArgsT>(args)...), state_(0)
+	{ }
+
+private:
+	unsigned char state_;
+};
+
+template<typename T, std::size_t TailV = reusable_tail<T>::value>
+class tail_padding_niche
+{
+public:
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool has_niche = true;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t offset = sizeof(T) - TailV;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t size = 1;
+	typedef tail_slot<T> slot_type;
+
+	static_assert(sizeof(slot_type) == sizeof(T), "The niche must not grow the object.");
+
+	static void set(void* object) EELS_NOEXCEPT_IF(true)
+	{ static_cast<unsigned char*>(object)[offset] = 1; }
+	static bool test(const void* object) EELS_NOEXCEPT_IF(true)
+	{ return static_cast<const unsigned char*>(object)[offset] != 0; }
+};
+
+template<typename T>
+class tail_padding_niche<T, 0>
+{
+public:
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool has_niche = false;
+};
+
+// 'slot_type' is optional in niche_traits and defaults to the type itself.
+template<typename TraitsT, typename T>
+class niche_slot
+{
+private:
+	template<typename U> static typename U::slot_type* check(typename U::slot_type*);
+	template<typename U> static T* check(...);
+
+public:
+	typedef typename std::remove_pointer<decltype(check<TraitsT>(0))>::type type;
+};
+
+} } }
+
+#endif // EELS_EXPECTED_DETAIL_NICHE_H_
@@ -0,0 +1,348 @@
+#ifndef EELS_EXPECTED_DETAIL_PIPELINE_H_
+#define EELS_EXPECTED_DETAIL_PIPELINE_H_
+
+#include <type_traits>
+#include <utility>
+#include <eels/config.h>
+#include <eels/expected/tags.h>
+#include <eels/expected/detail/call_result.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 {
+#else
+namespace eels { inline namespace expected_v1 {
+#endif
+
+template<typename ValueT, typename ErrorT>
+class expected;
+
+namespace detail {
+
+class map_t {};
+class and_then_t {};
+class or_else_t {};
+class map_error_t {};
+
+// How the alternatives of 'ExpectedT' are handed to the first stage: by lvalue reference when the source is an lvalue, moved otherwise.
+template<typename ExpectedT>
+class source_traits
+{
+private:
+	typedef typename std::remove_reference<ExpectedT>::type expected_type;
+	typedef typename std::conditional<std::is_const<expected_type>::value, const typename expected_type::value_type, typename expected_type::value_type>::type value_type;
+	typedef typename std::conditional<std::is_const<expected_type>::value, const typename expected_type::error_type, typename expected_type::error_type>::type error_type;
+
+public:
+	typedef typename std::conditional<std::is_lvalue_reference<ExpectedT>::value, value_type&, value_type&&>::type value_arg;
+	typedef typename std::conditional<std::is_lvalue_reference<ExpectedT>::value, error_type&, error_type&&>::type error_arg;
+};
+
+// What a stage hands to the next one, given what it receives.
+template<typename KindT, typename FunctionT, typename ValueArgT, typename ErrorArgT>
+class stage_types;
+
+template<typename FunctionT, typename ValueArgT, typename ErrorArgT>
+class stage_types<map_t, FunctionT, ValueArgT, ErrorArgT>
+{
+public:
+	typedef typename call_result<FunctionT&, ValueArgT>::type value_arg;
+	typedef ErrorArgT error_arg;
+};
+
+template<typename FunctionT, typename ValueArgT, typename ErrorArgT>
+class stage_types<and_then_t, FunctionT, ValueArgT, ErrorArgT>
+{
+private:
+	typedef typename std::decay<typename call_result<FunctionT&, ValueArgT>::type>::type result_type;
+	static_assert(std::is_same<typename result_type::error_type, typename std::decay<ErrorArgT>::type>::value, "The function given to 'and_then' must return an expected with the same error type.");
+
+public:
+	typedef typename result_type::value_type&& value_arg;
+	typedef ErrorArgT error_arg;
+};
+
+template<typename FunctionT, typename ValueArgT, typename ErrorArgT>
+class stage_types<or_else_t, FunctionT, ValueArgT, ErrorArgT>
+{
+private:
+	typedef typename std::decay<typename call_result<FunctionT&, ErrorArgT>::type>::type result_type;
+	static_assert(std::is_same<typename result_type::value_type, typename std::decay<ValueArgT>::type>::value, "The function given to 'or_else' must return an expected with the same value type.");
+
+public:
+	typedef ValueArgT value_arg;
+	typedef typename result_type::error_type&& error_arg;
+};
+
+template<typename FunctionT, typename ValueArgT, typename ErrorArgT>
+class stage_types<map_error_t, FunctionT, ValueArgT, ErrorArgT>
+{
+public:
+	typedef ValueArgT value_arg;
+	typedef typename call_result<FunctionT&, ErrorArgT>::type error_arg;
+};
+
+template<typename ValueArgT, typename ErrorArgT>
+class pipeline_result
+{
+public:
+	typedef expected<typename std::decay<ValueArgT>::type, typename std::decay<ErrorArgT>::type> type;
+};
+
+// Argument a stage gives to its function.
+template<typename KindT, typename ValueArgT, typename ErrorArgT>
+class stage_argument
+{
+public:
+	typedef ValueArgT type;
+};
+
+template<typename ValueArgT, typename ErrorArgT>
+class stage_argument<or_else_t, ValueArgT, ErrorArgT>
+{
+public:
+	typedef ErrorArgT type;
+};
+
+template<typename ValueArgT, typename ErrorArgT>
+class stage_argument<map_error_t, ValueArgT, ErrorArgT>
+{
+public:
+	typedef ErrorArgT type;
+};
+
+// Result of applying a single stage to 'ExpectedT', as done by the member functions of 'expected'.
+// Has no 'type' when the function cannot be called, so that overloads for other value categories are discarded.
+template<typename KindT, typename ExpectedT, typename FunctionT, typename EnableT = void>
+class stage_result
+{ };
+
+template<typename KindT, typename ExpectedT, typename FunctionT>
+class stage_result<KindT, ExpectedT, FunctionT, typename void_type<typename call_result<typename std::remove_reference<FunctionT>::type&, typename stage_argument<KindT, typename source_traits<ExpectedT>::value_arg, typename source_traits<ExpectedT>::error_arg>::type>::type>::type>
+{
+private:
+	typedef source_traits<ExpectedT> source_type;
+	typedef stage_types<KindT, typename std::remove_reference<FunctionT>::type, typename source_type::value_arg, typename source_type::error_arg> types;
+
+public:
+	typedef typename pipeline_result<typename types::value_arg, typename types::error_arg>::type type;
+};
+
+// Stages are run in continuation passing style: each one calls 'on_value' or 'on_error' on the next one,
+// so an error goes straight through the value stages and only the final expected is ever constructed.
+template<typename ResultT>
+class result_continuation
+{
+public:
+	typedef ResultT result_type;
+
+	template<typename T>
+	result_type on_value(T&& val) const { return result_type(in_place, std::forward<T>(val)); }
+
+	template<typename T>
+	result_type on_error(T&& err) const { return result_type(unexpected, std::forward<T>(err)); }
+};
+
+template<typename KindT, typename FunctionT, typename NextT>
+class stage_continuation;
+
+template<typename FunctionT, typename NextT>
+class stage_continuation<map_t, FunctionT, NextT>
+{
+public:
+	typedef typename NextT::result_type result_type;
+
+	stage_continuation(FunctionT& function, const NextT& next) : function_(&function), next_(&next) { }
+
+	template<typename T>
+	result_type on_value(T&& val) const { return next_->on_value((*function_)(std::forward<T>(val))); }
+
+	template<typename T>
+	result_type on_error(T&& err) const { return next_->on_error(std::forward<T>(err)); }
+
+private:
+	FunctionT* function_;
+	const NextT* next_;
+};
+
+template<typename FunctionT, typename NextT>
+class stage_continuation<and_then_t, FunctionT, NextT>
+{
+public:
+	typedef typename NextT::result_type result_type;
+
+	stage_continuation(FunctionT& function, const NextT& next) : function_(&function), next_(&next) { }
+
+	template<typename T>
+	result_type on_value(T&& val) const
+	{
+		typename std::decay<typename call_result<FunctionT&, T>::type>::type result((*function_)(std::forward<T>(val)));
+		if(result)
+			return next_->on_value(std::move(*result));
+		return next_->on_error(std::move(result.error()));
+	}
+
+	template<typename T>
+	result_type on_error(T&& err) const { return next_->on_error(std::forward<T>(err)); }
+
+private:
+	FunctionT* function_;
+	const NextT* next_;
+};
+
+template<typename FunctionT, typename NextT>
+class stage_continuation<or_else_t, FunctionT, NextT>
+{
+public:
+	typedef typename NextT::result_type result_type;
+
+	stage_continuation(FunctionT& function, const NextT& next) : function_(&function), next_(&next) { }
+
+	template<typename T>
+	result_type on_value(T&& val) const { return next_->on_value(std::forward<T>(val)); }
+
+	template<typename T>
+	result_type on_error(T&& err) const
+	{
+		typename std::decay<typename call_result<FunctionT&, T>::type>::type result((*function_)(std::forward<T>(err)));
+		if(result)
+			return next_->on_value(std::move(*result));
+		return next_->on_error(std::move(result.error()));
+	}
+
+private:
+	FunctionT* function_;
+	const NextT* next_;
+};
+
+template<typename FunctionT, typename NextT>
+class stage_continuation<map_error_t, FunctionT, NextT>
+{
+public:
+	typedef typename NextT::result_type result_type;
+
+	stage_continuation(FunctionT& function, const NextT& next) : function_(&function), next_(&next) { }
+
+	template<typename T>
+	result_type on_value(T&& val) const { return next_->on_value(std::forward<T>(val)); }
+
+	template<typename T>
+	result_type on_error(T&& err) const { return next_->on_error((*function_)(std::forward<T>(err))); }
+
+private:
+	FunctionT* function_;
+	const NextT* next_;
+};
+
+// Keeps the source of a pipeline: referenced when given by reference, owned otherwise.
+template<typename ExpectedT>
+class source_holder
+{
+public:
+	explicit source_holder(ExpectedT&& source) : source_(std::move(source)) { }
+	ExpectedT& get() { return source_; }
+
+private:
+	ExpectedT source_;
+};
+
+template<typename ExpectedT>
+class source_holder<ExpectedT&>
+{
+public:
+	explicit source_holder(ExpectedT& source) : source_(&source) { }
+	ExpectedT& get() { return *source_; }
+
+private:
+	ExpectedT* source_;
+};
+
+template<typename ExpectedT>
+class source_holder<ExpectedT&&>
+{
+public:
+	explicit source_holder(ExpectedT&& source) : source_(&source) { }
+	ExpectedT& get() { return *source_; }
+
+private:
+	ExpectedT* source_;
+};
+
+template<typename KindT, typename FunctionT>
+class stage
+{
+public:
+	typedef KindT kind_type;
+	typedef FunctionT function_type;
+
+	template<typename ArgT>
+	explicit stage(ArgT&& function) : function_(std::forward<ArgT>(function)) { }
+
+	function_type function_;
+};
+
+template<typename PreviousT, typename StageT>
+class pipeline;
+
+template<typename ExpectedT>
+class pipeline<ExpectedT, void>
+{
+public:
+	typedef typename source_traits<ExpectedT>::value_arg value_arg;
+	typedef typename source_traits<ExpectedT>::error_arg error_arg;
+	typedef typename pipeline_result<value_arg, error_arg>::type result_type;
+
+	explicit pipeline(ExpectedT&& source) : source_(std::forward<ExpectedT>(source)) { }
+
+	template<typename ContinuationT>
+	typename ContinuationT::result_type run(const ContinuationT& next)
+	{
+		if(source_.get())
+			return next.on_value(static_cast<value_arg>(*source_.get()));
+		return next.on_error(static_cast<error_arg>(source_.get().error()));
+	}
+
+	result_type evaluate() { return run(result_continuation<result_type>()); }
+	operator result_type() { return evaluate(); }
+
+private:
+	source_holder<ExpectedT> source_;
+};
+
+template<typename PreviousT, typename KindT, typename FunctionT>
+class pipeline<PreviousT, stage<KindT, FunctionT> >
+{
+private:
+	typedef stage_types<KindT, FunctionT, typename PreviousT::value_arg, typename PreviousT::error_arg> types;
+
+public:
+	typedef typename types::value_arg value_arg;
+	typedef typename types::error_arg error_arg;
+	typedef typename pipeline_result<value_arg, error_arg>::type result_type;
+
+	pipeline(PreviousT&& previous, stage<KindT, FunctionT>&& s) : previous_(std::move(previous)), function_(std::move(s.function_)) { }
+
+	template<typename ContinuationT>
+	typename ContinuationT::result_type run(const ContinuationT& next)
+	{ return previous_.run(stage_continuation<KindT, FunctionT, ContinuationT>(function_, next)); }
+
+	result_type evaluate() { return run(result_continuation<result_type>()); }
+	operator result_type() { return evaluate(); }
+
+private:
+	PreviousT previous_;
+	FunctionT function_;
+};
+
+// Applies a single stage right away, without storing the function.
+template<typename KindT, typename ExpectedT, typename FunctionT>
+typename stage_result<KindT, ExpectedT, FunctionT>::type apply_stage(ExpectedT&& source, FunctionT&& function)
+{
+	typedef typename stage_result<KindT, ExpectedT, FunctionT>::type result_type;
+	typedef result_continuation<result_type> result_continuation_type;
+	const result_continuation_type result;
+	return pipeline<ExpectedT&&, void>(std::forward<ExpectedT>(source)).run(stage_continuation<KindT, typename std::remove_reference<FunctionT>::type, result_continuation_type>(function, result));
+}
+
+} } }
+
+#endif // EELS_EXPECTED_DETAIL_PIPELINE_H_
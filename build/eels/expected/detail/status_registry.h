@@ -0,0 +1,175 @@
+#ifndef EELS_EXPECTED_DETAIL_STATUS_REGISTRY_H_
+#define EELS_EXPECTED_DETAIL_STATUS_REGISTRY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
+#include <eels/config.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 {
+#else
+namespace eels { inline namespace expected_v1 {
+#endif
+
+class status_domain;
+
+namespace detail {
+
+// Payload of a status that does not fit in a word: interned, so equal payloads share a record,
+// and never freed, so statuses can copy their pointer around freely.
+class status_record
+{
+public:
+    status_record(unsigned domain, int code, const char* payload, std::size_t size) : domain(domain), code(code), payload(payload), size(size) { }
+
+    unsigned domain;
+    int code;
+    const char* payload;    // null-terminated, null when there is none
+    std::size_t size;
+};
+
+class status_record_hash
+{
+public:
+    std::size_t operator()(const status_record* record) const
+    {
+        // FNV-1a over the text, mixed with the domain and code
+        std::size_t hash = static_cast<std::size_t>(2166136261u) ^ (static_cast<std::size_t>(record->domain) << 16) ^ static_cast<std::size_t>(record->code);
+        const char* const text = record->payload;
+        for(std::size_t i = 0; i < record->size; ++i)
+            hash = (hash ^ static_cast<unsigned char>(text[i])) * static_cast<std::size_t>(16777619u);
+        return hash;
+    }
+};
+
+class status_record_equal
+{
+public:
+    bool operator()(const status_record* lhs, const status_record* rhs) const
+    {
+        return lhs->domain == rhs->domain && lhs->code == rhs->code && lhs->size == rhs->size
+            && (!lhs->size || std::memcmp(lhs->payload, rhs->payload, lhs->size) == 0);
+    }
+};
+
+// Domains of statuses, and the records holding their payloads.
+// Looking a domain up takes no lock, registering one and interning a payload do.
+class status_registry
+{
+private:
+    typedef std::unordered_set<const status_record*, status_record_hash, status_record_equal> record_set;
+
+public:
+    static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t max_domains = 256;
+    static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t arena_block_size = 16 * 1024;
+
+    // never destroyed, like the records it hands out: statuses may still be made during static destruction
+    static status_registry& instance()
+    {
+        static status_registry* registry = new status_registry();
+        return *registry;
+    }
+
+    unsigned add(const status_domain& domain)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(domain_count_ == max_domains)
+            throw std::length_error("Too many status domains.");
+        domains_[domain_count_].store(&domain, std::memory_order_release);
+        return domain_count_++;
+    }
+
+    // null for the generic domain and unregistered ones
+    const status_domain* find(unsigned domain) const
+    {
+        return domain < max_domains ? domains_[domain].load(std::memory_order_acquire) : nullptr;
+    }
+
+    const status_record* intern(unsigned domain, int code, const char* payload, std::size_t size)
+    {
+        // payloads usually come from the same few places, a per-thread cache keyed by their address avoids the lock
+        cache_type& cache = local_cache();
+        const status_record*& cached = cache[(reinterpret_cast<std::uintptr_t>(payload) / 8 ^ static_cast<std::uintptr_t>(code) ^ domain) % cache_size];
+        const status_record key(domain, code, payload, size);
+        if(!cached || !status_record_equal()(cached, &key))
+            cached = find_or_insert(key);
+        return cached;
+    }
+
+private:
+    static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t cache_size = 16;
+    typedef const status_record* cache_type[cache_size];
+
+    static cache_type& local_cache()
+    {
+        static EELS_CXX11_THREAD_LOCAL cache_type cache = {};
+        return cache;
+    }
+
+    const status_record* find_or_insert(const status_record& key)
+    {
+        const std::size_t size = key.size;
+        std::lock_guard<std::mutex> lock(mutex_);
+        const record_set::const_iterator it = records_.find(&key);
+        if(it != records_.end())
+            return *it;
+
+        // the text is stored right after the record
+        void* const memory = allocate(sizeof(status_record) + (size ? size + 1 : 0));
+        char* const text = size ? static_cast<char*>(memory) + sizeof(status_record) : nullptr;
+        if(size)
+        {
+            std::memcpy(text, key.payload, size);
+            text[size] = '\0';
+        }
+        const status_record* const record = ::new(memory) status_record(key.domain, key.code, text, size);
+        records_.insert(record);
+        return record;
+    }
+
+    // domain 0 is the generic domain, which is not registered
+    status_registry() : domain_count_(1), arena_(nullptr), arena_left_(0)
+    {
+        for(std::size_t i = 0; i < max_domains; ++i)
+            domains_[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    status_registry(const status_registry&);
+    status_registry& operator=(const status_registry&);
+
+    // records live as long as the program, the arena is never released
+    void* allocate(std::size_t size)
+    {
+        size = (size + std::alignment_of<status_record>::value - 1) / std::alignment_of<status_record>::value * std::alignment_of<status_record>::value;
+        if(size > arena_block_size)
+            return ::operator new(size);
+        if(size > arena_left_)
+        {
+            arena_ = static_cast<char*>(::operator new(arena_block_size));
+            arena_left_ = arena_block_size;
+        }
+        void* const memory = arena_;
+        arena_ += size;
+        arena_left_ -= size;
+        return memory;
+    }
+
+private:
+    std::atomic<const status_domain*> domains_[max_domains];
+    std::mutex mutex_;
+    unsigned domain_count_;
+    record_set records_;
+    char* arena_;
+    std::size_t arena_left_;
+};
+
+} } }
+
+#endif // EELS_EXPECTED_DETAIL_STATUS_REGISTRY_H_
@@ -9,6 +9,7 @@
 #include <eels/config.h>
 #include <eels/expected/tags.h>
 #include <eels/expected/detail/buffer.h>
+#include <eels/expected/detail/instrumentation.h>
 #include <eels/expected/detail/tuple_indices.h>
 
 #if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
@@ -18,29 +19,53 @@ namespace eels { inline namespace expected_v1 { namespace detail {
 #endif
 
 class empty_storage_access {};
-
-template<typename StorageT, typename ValueT, typename TagT, typename NextT>
+class uninitialized_storage_t {};
+
+// Whether a list of constructor arguments is a single object of type T, which can then be assigned instead.
+template<typename T, typename... ArgsT>
+class is_value_argument
+	: public std::false_type
+{ };
+
+template<typename T, typename ArgT>
+class is_value_argument<T, ArgT>
+	: public std::is_same<T, typename std::decay<ArgT>::type>
+{ };
+
+// Whether a list of constructor arguments is a single storage layer, which must go to the copy or move constructor
+// of a layer rather than to its forwarding one.
+template<typename StorageT, typename... ArgsT>
+class is_storage_argument
+	: public std::false_type
+{ };
+
+template<typename StorageT, typename ArgT>
+class is_storage_argument<StorageT, ArgT>
+	: public std::is_base_of<StorageT, typename std::decay<ArgT>::type>
+{ };
+
+template<typename StorageT, typename ValueT, typename SlotT, typename TagT, typename NextT>
 class storage_access
 	: public NextT
 {
-private:
+public:
 	typedef StorageT storage_type;
 	typedef ValueT value_type;
+	typedef SlotT slot_type;
 	typedef TagT tag_type;
 
-public:
 	template<typename... ArgsT>
 	EELS_CXX14_CONSTEXPR void construct(ArgsT&&... args)
-	{ ::new(storage()) value_type(std::forward<ArgsT>(args)...); }
+	{ ::new(storage()) slot_type(std::forward<ArgsT>(args)...); }
 
 	EELS_CXX14_CONSTEXPR void construct(const value_type& val)
-	{ ::new(storage()) value_type(val); }
+	{ ::new(storage()) slot_type(val); }
 
 	EELS_CXX14_CONSTEXPR void construct(value_type&& val)
-	{ ::new(storage()) value_type(std::move(val)); }
+	{ ::new(storage()) slot_type(std::move(val)); }
 
 	EELS_CXX14_CONSTEXPR void destruct()
-	{ get().~value_type(); }
+	{ slot().~slot_type(); }
 
 	EELS_CXX14_CONSTEXPR void assign(const value_type& val)
 	{ get() = val; }
@@ -49,24 +74,27 @@ public:
 	{ get() = std::move(val); }
 
 #if defined(EELS_NO_CXX11_REF_QUALIFIERS)
-    EELS_CXX14_CONSTEXPR value_type& get() { return *reinterpret_cast<value_type*>(storage()); }
-    EELS_CXX14_CONSTEXPR const value_type& get() const { return *reinterpret_cast<const value_type*>(storage()); }
+    EELS_CXX14_CONSTEXPR value_type& get() { return slot(); }
+    EELS_CXX14_CONSTEXPR const value_type& get() const { return slot(); }
 #else
-    EELS_CXX14_CONSTEXPR value_type& get() & { return *reinterpret_cast<value_type*>(storage()); }
-    EELS_CXX14_CONSTEXPR const value_type& get() const& { return *reinterpret_cast<const value_type*>(storage()); }
-    EELS_CXX14_CONSTEXPR value_type&& get() && { return *reinterpret_cast<value_type*>(storage()); }
+    EELS_CXX14_CONSTEXPR value_type& get() & { return slot(); }
+    EELS_CXX14_CONSTEXPR const value_type& get() const& { return slot(); }
+    EELS_CXX14_CONSTEXPR value_type&& get() && { return std::move(slot()); }
 #endif // EELS_REFQUALIFIERS
 
 private:
-	void* storage() { return static_cast<typename storage_type::buffer_type*>(static_cast<storage_type*>(this))->template get<tag_type>(); }
-	const void* storage() const { return static_cast<const typename storage_type::buffer_type*>(static_cast<const storage_type*>(this))->template get<tag_type>(); }
+	slot_type& slot() { return *reinterpret_cast<slot_type*>(storage()); }
+	const slot_type& slot() const { return *reinterpret_cast<const slot_type*>(storage()); }
+
+	void* storage() { return static_cast<typename storage_type::buffer_type*>(static_cast<storage_type*>(this))->get(tag_type()); }
+	const void* storage() const { return static_cast<const typename storage_type::buffer_type*>(static_cast<const storage_type*>(this))->get(tag_type()); }
 };
 
 template<typename ValueT, typename ErrorT>
 class storage_base
 	: public buffer_selector<ValueT, ErrorT>::type,
-	  public storage_access<storage_base<ValueT, ErrorT>, ErrorT, error_from_buffer_t,
-			 storage_access<storage_base<ValueT, ErrorT>, ValueT, value_from_buffer_t, empty_storage_access>
+	  public storage_access<storage_base<ValueT, ErrorT>, ErrorT, typename buffer_selector<ValueT, ErrorT>::type::error_slot_type, error_from_buffer_t,
+			 storage_access<storage_base<ValueT, ErrorT>, ValueT, typename buffer_selector<ValueT, ErrorT>::type::value_slot_type, value_from_buffer_t, empty_storage_access>
 	  >
 {
 public:
@@ -75,66 +103,196 @@ public:
 	typedef typename buffer_selector<value_type, error_type>::type buffer_type;
 
 protected:
-	typedef storage_access<storage_base<ValueT, ErrorT>, ValueT, value_from_buffer_t, empty_storage_access> value_access_type;
-	typedef storage_access<storage_base<ValueT, ErrorT>, ErrorT, error_from_buffer_t, value_access_type> error_access_type;
+	typedef storage_access<storage_base<ValueT, ErrorT>, ValueT, typename buffer_type::value_slot_type, value_from_buffer_t, empty_storage_access> value_access_type;
+	typedef storage_access<storage_base<ValueT, ErrorT>, ErrorT, typename buffer_type::error_slot_type, error_from_buffer_t, value_access_type> error_access_type;
 
 public:
-	// default, copy and move constructors
+	// default constructor
 	EELS_CXX14_CONSTEXPR storage_base()
-		: is_valid_(false)
 	{
 		error_access_type::construct();
+		buffer_type::select(error_from_buffer_t());
+		EELS_EXPECTED_COUNT(construction_counter);
+		EELS_EXPECTED_COUNT(error_construction_counter);
 	}
 
-	EELS_CXX14_CONSTEXPR storage_base(const storage_base<value_type, error_type>& other)
-		: is_valid_(other.valid())
-	{
-		if(valid())
-			value_access_type::construct(other.value());
-		else
-			error_access_type::construct(other.error());
-	}
-
-	EELS_CXX14_CONSTEXPR storage_base(storage_base<value_type, error_type>&& other)
-		: is_valid_(other.valid())
-	{
-		if(valid())
-			value_access_type::construct(std::move(other.value()));
-		else
-			error_access_type::construct(std::move(other.error()));
-	}
+	// leaves the buffer uninitialized, the caller constructs one alternative right after
+	EELS_CXX14_CONSTEXPR explicit storage_base(uninitialized_storage_t)
+	{ }
 
 	// value constructors
 	EELS_CXX14_CONSTEXPR storage_base(const value_type& val)
-		: is_valid_(true)
 	{
 		value_access_type::construct(val);
+		buffer_type::select(value_from_buffer_t());
+		EELS_EXPECTED_COUNT(construction_counter);
 	}
 	EELS_CXX14_CONSTEXPR storage_base(value_type&& val)
-		: is_valid_(true)
 	{
 		value_access_type::construct(std::move(val));
+		buffer_type::select(value_from_buffer_t());
+		EELS_EXPECTED_COUNT(construction_counter);
 	}
 
 	// in_place constructors
 	template<typename... ArgsT>
 	EELS_CXX14_CONSTEXPR storage_base(in_place_t, ArgsT&&... args)
-		: is_valid_(true)
 	{
 		value_access_type::construct(std::forward<ArgsT>(args)...);
+		buffer_type::select(value_from_buffer_t());
+		EELS_EXPECTED_COUNT(construction_counter);
 	}
 
 	// unexpected constructors
 	template<typename... ArgsT>
 	EELS_CXX14_CONSTEXPR storage_base(unexpected_t, ArgsT&&... args)
-		: is_valid_(false)
 	{
 		error_access_type::construct(std::forward<ArgsT>(args)...);
+		buffer_type::select(error_from_buffer_t());
+		EELS_EXPECTED_COUNT(construction_counter);
+		EELS_EXPECTED_COUNT(error_construction_counter);
+	}
+
+	// factory constructors
+	template<typename... ArgsT, std::size_t... Indices>
+	EELS_CXX14_CONSTEXPR storage_base(std::tuple<ArgsT...>&& factory, const tuple_indices<Indices...>&)
+		: storage_base(std::forward<ArgsT>(std::get<Indices>(factory))...)
+	{ }
+
+	// value assignment
+	storage_base<value_type, error_type>& assign(const value_type& val)
+	{
+		if(valid())
+			value_access_type::assign(val);
+		else
+			buffer_type::switch_fromto(static_cast<error_access_type&>(*this), static_cast<value_access_type&>(*this), val);
+		return *this;
+	}
+
+	storage_base<value_type, error_type>& assign(value_type&& val)
+	{
+		if(valid())
+			value_access_type::assign(std::move(val));
+		else
+			buffer_type::switch_fromto(static_cast<error_access_type&>(*this), static_cast<value_access_type&>(*this), std::move(val));
+		return *this;
+	}
+
+	// error assignment
+	template<typename ArgT>
+	storage_base<value_type, error_type>& assign_error(ArgT&& err)
+	{
+		if(valid())
+			buffer_type::switch_fromto(static_cast<value_access_type&>(*this), static_cast<error_access_type&>(*this), std::forward<ArgT>(err));
+		else
+			error_access_type::assign(std::forward<ArgT>(err));
+		return *this;
+	}
+
+	// in_place assignment, a single value is assigned, anything else is emplaced
+	template<typename... ArgsT>
+	storage_base<value_type, error_type>& assign(in_place_t, ArgsT&&... args)
+	{
+		assign_or_emplace(in_place, is_value_argument<value_type, ArgsT...>(), std::forward<ArgsT>(args)...);
+		return *this;
 	}
 
-	// copy and move assignment operators
-	storage_base<value_type, error_type>& operator=(const storage_base<value_type, error_type>& other)
+	// unexpected assignment, a single error is assigned, anything else is emplaced
+	template<typename... ArgsT>
+	storage_base<value_type, error_type>& assign(unexpected_t, ArgsT&&... args)
+	{
+		assign_or_emplace(unexpected, is_value_argument<error_type, ArgsT...>(), std::forward<ArgsT>(args)...);
+		return *this;
+	}
+
+	// emplacement, constructs the new value or error directly in the buffer
+	template<typename... ArgsT>
+	value_type& emplace(in_place_t, ArgsT&&... args)
+	{
+		if(valid())
+			replace(static_cast<value_access_type&>(*this), can_replace_in_place<value_type, ArgsT...>(), std::forward<ArgsT>(args)...);
+		else
+			buffer_type::switch_fromto(static_cast<error_access_type&>(*this), static_cast<value_access_type&>(*this), std::forward<ArgsT>(args)...);
+		return value_access_type::get();
+	}
+
+	template<typename... ArgsT>
+	error_type& emplace(unexpected_t, ArgsT&&... args)
+	{
+		if(valid())
+			buffer_type::switch_fromto(static_cast<value_access_type&>(*this), static_cast<error_access_type&>(*this), std::forward<ArgsT>(args)...);
+		else
+			replace(static_cast<error_access_type&>(*this), can_replace_in_place<error_type, ArgsT...>(), std::forward<ArgsT>(args)...);
+		return error_access_type::get();
+	}
+
+	// factory assignment
+	template<typename... ArgsT, std::size_t... Indices>
+	storage_base<value_type, error_type>& assign(std::tuple<ArgsT...>&& factory, const tuple_indices<Indices...>&)
+	{
+		return assign(std::forward<ArgsT>(std::get<Indices>(factory))...);
+	}
+
+	// observers
+	EELS_CXX14_CONSTEXPR bool valid() const { return buffer_type::valid(); }
+
+#if defined(EELS_NO_CXX11_REF_QUALIFIERS)
+	EELS_CXX14_CONSTEXPR value_type& value() { assert(valid());  return value_access_type::get(); }
+	EELS_CXX14_CONSTEXPR const value_type& value() const { assert(valid());  return value_access_type::get(); }
+#else
+	EELS_CXX14_CONSTEXPR value_type& value() & { assert(valid());  return value_access_type::get(); }
+	EELS_CXX14_CONSTEXPR const value_type& value() const& { assert(valid());  return value_access_type::get(); }
+	EELS_CXX14_CONSTEXPR value_type&& value() && { assert(valid());  return std::move(*this).value_access_type::get(); }
+#endif // EELS_REFQUALIFIERS
+
+#if defined(EELS_NO_CXX11_REF_QUALIFIERS)
+	EELS_CXX14_CONSTEXPR error_type& error() { assert(!valid());  return error_access_type::get(); }
+	EELS_CXX14_CONSTEXPR const error_type& error() const { assert(!valid());  return error_access_type::get(); }
+#else
+	EELS_CXX14_CONSTEXPR error_type& error() & { assert(!valid());  return error_access_type::get(); }
+	EELS_CXX14_CONSTEXPR const error_type& error() const& { assert(!valid());  return error_access_type::get(); }
+	EELS_CXX14_CONSTEXPR error_type&& error() && { assert(!valid());  return std::move(*this).error_access_type::get(); }
+#endif // EELS_REFQUALIFIERS
+
+protected:
+	// special members building blocks, used by the layers below when the alternatives are not trivial
+	void construct_from(const storage_base<value_type, error_type>& other)
+	{
+		if(other.valid())
+		{
+			value_access_type::construct(other.value());
+			buffer_type::select(value_from_buffer_t());
+		}
+		else
+		{
+			error_access_type::construct(other.error());
+			buffer_type::select(error_from_buffer_t());
+			EELS_EXPECTED_COUNT(error_construction_counter);
+		}
+		EELS_EXPECTED_COUNT(construction_counter);
+		EELS_EXPECTED_COUNT(copy_counter);
+	}
+
+	void construct_from(storage_base<value_type, error_type>&& other)
 	{
+		if(other.valid())
+		{
+			value_access_type::construct(std::move(other.value()));
+			buffer_type::select(value_from_buffer_t());
+		}
+		else
+		{
+			error_access_type::construct(std::move(other.error()));
+			buffer_type::select(error_from_buffer_t());
+			EELS_EXPECTED_COUNT(error_construction_counter);
+		}
+		EELS_EXPECTED_COUNT(construction_counter);
+		EELS_EXPECTED_COUNT(move_counter);
+	}
+
+	void assign_from(const storage_base<value_type, error_type>& other)
+	{
+		EELS_EXPECTED_COUNT(copy_counter);
 		if(other.valid())
 		{
 			const auto& value = static_cast<const value_access_type&>(other).get();
@@ -149,246 +307,320 @@ public:
 			if(valid())
 				buffer_type::switch_fromto(static_cast<value_access_type&>(*this), static_cast<error_access_type&>(*this), err);
 			else
-				error_access_type::assign(err);				
+				error_access_type::assign(err);
 		}
-		is_valid_ = other.valid();
-		return *this;
 	}
 
-	storage_base<value_type, error_type>& operator=(storage_base<value_type, error_type>&& other)
+	void assign_from(storage_base<value_type, error_type>&& other)
 	{
+		EELS_EXPECTED_COUNT(move_counter);
 		if (other.valid())
-		{
-			auto value = std::move(static_cast<value_access_type&&>(other).get());
-			if (valid())
-				value_access_type::assign(std::move(value));
-			else
-				buffer_type::switch_fromto(static_cast<error_access_type&>(*this), static_cast<value_access_type&>(*this), std::move(value));
-		}
+			assign(std::move(static_cast<value_access_type&&>(other).get()));
 		else
-		{
-			auto err = std::move(static_cast<error_access_type&&>(other).get());
-			if (valid())
-				buffer_type::switch_fromto(static_cast<value_access_type&>(*this), static_cast<error_access_type&>(*this), std::move(err));
-			else
-				error_access_type::assign(std::move(err));
-		}
-		is_valid_ = other.valid();
-		return *this;
+			assign_error(std::move(static_cast<error_access_type&&>(other).get()));
 	}
 
-    // value assignment operators
-    storage_base<value_type, error_type>& operator=(const value_type& val)
-    {
-        if(valid())
-            value_access_type::assign(val);
-        else
-            buffer_type::switch_fromto(static_cast<error_access_type&>(*this), static_cast<value_access_type&>(*this), value);
-        is_valid_ = true;
-        return *this;
-    }
-
-    storage_base<value_type, error_type>& operator=(value_type&& val)
-    {
-        if(valid())
-            value_access_type::assign(std::move(val));
-        else
-            buffer_type::switch_fromto(static_cast<error_access_type&>(*this), static_cast<value_access_type&>(*this), std::move(val));
-        is_valid_ = true;
-        return *this;
-    }
-
-    // in_place assignment
-    template<typename... ArgsT>
-    storage_base<value_type, error_type>& assign(in_place_t, ArgsT&&... args)
-    {
-        if(valid())
-            value_access_type::assign(value_type(std::forward<ArgsT>(args)...));            
-        else
-            buffer_type::switch_fromto(static_cast<error_access_type&>(*this), static_cast<value_access_type&>(*this), std::forward<ArgsT>(args)...);
-        is_valid_ = true;
-        return *this;
-    }
-
-    // unexpected assignment
-    template<typename... ArgsT>
-    storage_base<value_type, error_type>& assign(unexpected_t, ArgsT&&... args)
-    {
-        if(valid())
-            buffer_type::switch_fromto(static_cast<value_access_type&>(*this), static_cast<error_access_type&>(*this), std::forward<ArgsT>(args)...);
-        else
-            error_access_type::assign(error_type(std::forward<ArgsT>(args)...));
-        is_valid_ = false;
-        return *this;
-    }
-    
-    // observers
-	EELS_CXX14_CONSTEXPR bool valid() const { return is_valid_; }
+	void destroy()
+	{
+		if(valid())
+			value_access_type::destruct();
+		else
+			error_access_type::destruct();
+	}
 
-#if defined(EELS_NO_CXX11_REF_QUALIFIERS)
-    EELS_CXX14_CONSTEXPR value_type& value() { assert(valid());  return value_access_type::get(); }
-    EELS_CXX14_CONSTEXPR const value_type& value() const { assert(valid());  return value_access_type::get(); }
-#else
-    EELS_CXX14_CONSTEXPR value_type& value() & { assert(valid());  return value_access_type::get(); }
-    EELS_CXX14_CONSTEXPR const value_type& value() const& { assert(valid());  return value_access_type::get(); }
-    EELS_CXX14_CONSTEXPR value_type&& value() && { assert(valid());  return value_access_type::get(); }
-#endif // EELS_REFQUALIFIERS
+private:
+	// Replacing an alternative by a new one of the same type can be done in place when it cannot leave the buffer empty.
+	template<typename T, typename... ArgsT>
+	class can_replace_in_place
+		: public std::integral_constant<bool, std::is_nothrow_constructible<T, ArgsT...>::value || std::is_nothrow_move_constructible<T>::value>
+	{ };
 
-#if defined(EELS_NO_CXX11_REF_QUALIFIERS)
-    EELS_CXX14_CONSTEXPR error_type& error() { assert(!valid());  return error_access_type::get(); }
-    EELS_CXX14_CONSTEXPR const error_type& error() const { assert(!valid());  return error_access_type::get(); }
-#else
-    EELS_CXX14_CONSTEXPR error_type& error() & { assert(!valid());  return error_access_type::get(); }
-    EELS_CXX14_CONSTEXPR const error_type& error() const& { assert(!valid());  return error_access_type::get(); }
-    EELS_CXX14_CONSTEXPR error_type&& error() && { assert(!valid());  return error_access_type::get(); }
-#endif // EELS_REFQUALIFIERS
+	template<typename AccessT, typename... ArgsT>
+	void replace(AccessT& access, std::true_type, ArgsT&&... args)
+	{ switch_overlapping(static_cast<buffer_type&>(*this), access, access, typename overlapping_switch_selector<AccessT, AccessT, ArgsT...>::type(), std::forward<ArgsT>(args)...); }
 
-private:
-	bool is_valid_;
+	template<typename AccessT, typename... ArgsT>
+	void replace(AccessT& access, std::false_type, ArgsT&&... args)
+	{ access.assign(typename AccessT::value_type(std::forward<ArgsT>(args)...)); }
+
+	template<typename ArgT>
+	void assign_or_emplace(in_place_t, std::true_type, ArgT&& val)
+	{ assign(std::forward<ArgT>(val)); }
+
+	template<typename... ArgsT>
+	void assign_or_emplace(in_place_t, std::false_type, ArgsT&&... args)
+	{ emplace(in_place, std::forward<ArgsT>(args)...); }
+
+	template<typename ArgT>
+	void assign_or_emplace(unexpected_t, std::true_type, ArgT&& err)
+	{ assign_error(std::forward<ArgT>(err)); }
+
+	template<typename... ArgsT>
+	void assign_or_emplace(unexpected_t, std::false_type, ArgsT&&... args)
+	{ emplace(unexpected, std::forward<ArgsT>(args)...); }
 };
 
+// Both alternatives are trivially copyable: every special member is implicit, hence trivial.
 template<typename ValueT, typename ErrorT>
 class trivial_storage
 	: public storage_base<ValueT, ErrorT>
 {
 private:
-    typedef storage_base<ValueT, ErrorT> base_type;
+	typedef storage_base<ValueT, ErrorT> base_type;
+
+public:
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR trivial_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
+};
+
+// Otherwise, each special member is provided by its own layer, and stays trivial when the alternatives allow it.
+// The destructor layer comes after the constructor ones so that a throwing copy or move never destroys an unconstructed buffer.
+template<typename ValueT, typename ErrorT,
+		 bool TrivialV = allow_trivial_storage && std::is_trivially_copy_constructible<ValueT>::value && std::is_trivially_copy_constructible<ErrorT>::value>
+class copy_constructible_storage
+	: public storage_base<ValueT, ErrorT>
+{
+private:
+	typedef storage_base<ValueT, ErrorT> base_type;
 
 public:
-    EELS_CXX14_CONSTEXPR trivial_storage()
-        : base_type()
-    { }
-    EELS_CXX14_CONSTEXPR trivial_storage(const trivial_storage<value_type, error_type>& other)
-        : base_type(other)
-    { }
-    EELS_CXX14_CONSTEXPR trivial_storage(trivial_storage<value_type, error_type>&& other)
-        : base_type(std::move(other))
-    { }
-    EELS_CXX14_CONSTEXPR trivial_storage(const value_type& val)
-        : base_type(val)
-    { }
-    EELS_CXX14_CONSTEXPR trivial_storage(value_type&& val)
-        : base_type(std::move(val))
-    { }
-    template<typename... ArgsT>
-    EELS_CXX14_CONSTEXPR trivial_storage(in_place_t, ArgsT&&... args)
-        : base_type(in_place, std::forward<ArgsT>(args)...)
-    { }
-    template<typename... ArgsT>
-    EELS_CXX14_CONSTEXPR trivial_storage(unexpected_t, ArgsT&&... args)
-        : base_type(unexpected, std::forward<ArgsT>(args)...)
-    { }
-    template<typename... ArgsT, std::size_t... Indices>
-    EELS_CXX14_CONSTEXPR trivial_storage(std::tuple<ArgsT...>&& factory, const tuple_indices<Indices...>&)
-        : base_type(std::forward<ArgsT>(std::get<Indices>(factory))...)
-    { }
-
-    trivial_storage<value_type, error_type>& operator=(const trivial_storage<value_type, error_type>& other)
-    {
-        base_type::operator=(other);
-        return *this;
-    }
-
-    trivial_storage<value_type, error_type>& operator=(trivial_storage<value_type, error_type>&& other)
-    {
-        base_type::operator=(std::move(other));
-        return *this;
-    }
-
-    trivial_storage<value_type, error_type>& operator=(const value_type& val)
-    {
-        base_type::operator=(val);
-        return *this;
-    }
-
-    trivial_storage<value_type, error_type>& operator=(value_type&& val)
-    {
-        base_type::operator=(std::move(val));
-        return *this;
-    }
-
-    template<typename... ArgsT, std::size_t... Indices>
-    trivial_storage<value_type, error_type>& assign(std::tuple<ArgsT...>&& factory, const tuple_indices<Indices...>&)
-    {
-        base_type::assign(std::forward<ArgsT>(std::get<Indices>(factory))...);
-        return *this;
-    }
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR copy_constructible_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
 };
 
 template<typename ValueT, typename ErrorT>
-class nontrivial_storage
+class copy_constructible_storage<ValueT, ErrorT, false>
 	: public storage_base<ValueT, ErrorT>
 {
 private:
-    typedef storage_base<ValueT, ErrorT> base_type;
+	typedef storage_base<ValueT, ErrorT> base_type;
 
 public:
-    EELS_CXX14_CONSTEXPR nontrivial_storage()
-        : base_type()
-    { }
-    EELS_CXX14_CONSTEXPR nontrivial_storage(const nontrivial_storage<value_type, error_type>& other)
-        : base_type(other)
-    { }
-    EELS_CXX14_CONSTEXPR nontrivial_storage(nontrivial_storage<value_type, error_type>&& other)
-        : base_type(std::move(other))
-    { }
-    EELS_CXX14_CONSTEXPR nontrivial_storage(const value_type& val)
-        : base_type(val)
-    { }
-    EELS_CXX14_CONSTEXPR nontrivial_storage(value_type&& val)
-        : base_type(std::move(val))
-    { }
-    template<typename... ArgsT>
-    EELS_CXX14_CONSTEXPR nontrivial_storage(in_place_t, ArgsT&&... args)
-        : base_type(in_place, std::forward<ArgsT>(args)...)
-    { }
-    template<typename... ArgsT>
-    EELS_CXX14_CONSTEXPR nontrivial_storage(unexpected_t, ArgsT&&... args)
-        : base_type(unexpected, std::forward<ArgsT>(args)...)
-    { }
-    template<typename... ArgsT, std::size_t... Indices>
-    EELS_CXX14_CONSTEXPR nontrivial_storage(std::tuple<ArgsT...>&& factory, const tuple_indices<Indices...>& )
-        : base_type(std::forward<ArgsT>(std::get<Indices>(factory))...)
-    { }
-
-	~nontrivial_storage()
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR copy_constructible_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
+
+	copy_constructible_storage(const copy_constructible_storage<ValueT, ErrorT, false>& other) EELS_NOEXCEPT_IF((std::is_nothrow_copy_constructible<ValueT>::value && std::is_nothrow_copy_constructible<ErrorT>::value))
+		: base_type(uninitialized_storage_t())
 	{
-		if(valid())
-			value_access_type::destruct();
-		else
-			error_access_type::destruct();
+		base_type::construct_from(other);
+	}
+
+	copy_constructible_storage<ValueT, ErrorT, false>& operator=(const copy_constructible_storage<ValueT, ErrorT, false>&) = default;
+#if defined(EELS_NO_CXX11_DEFAULTED_MOVE)
+	copy_constructible_storage(copy_constructible_storage<ValueT, ErrorT, false>&& other)
+		: base_type(std::move(other))
+	{ }
+	copy_constructible_storage<ValueT, ErrorT, false>& operator=(copy_constructible_storage<ValueT, ErrorT, false>&& other)
+	{
+		base_type::operator=(std::move(other));
+		return *this;
+	}
+#else
+	copy_constructible_storage(copy_constructible_storage<ValueT, ErrorT, false>&&) = default;
+	copy_constructible_storage<ValueT, ErrorT, false>& operator=(copy_constructible_storage<ValueT, ErrorT, false>&&) = default;
+#endif // EELS_NO_CXX11_DEFAULTED_MOVE
+};
+
+template<typename ValueT, typename ErrorT,
+		 bool TrivialV = allow_trivial_storage && std::is_trivially_move_constructible<ValueT>::value && std::is_trivially_move_constructible<ErrorT>::value>
+class move_constructible_storage
+	: public copy_constructible_storage<ValueT, ErrorT>
+{
+private:
+	typedef copy_constructible_storage<ValueT, ErrorT> base_type;
+
+public:
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR move_constructible_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
+};
+
+template<typename ValueT, typename ErrorT>
+class move_constructible_storage<ValueT, ErrorT, false>
+	: public copy_constructible_storage<ValueT, ErrorT>
+{
+private:
+	typedef copy_constructible_storage<ValueT, ErrorT> base_type;
+
+public:
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR move_constructible_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
+
+	move_constructible_storage(const move_constructible_storage<ValueT, ErrorT, false>&) = default;
+
+	move_constructible_storage(move_constructible_storage<ValueT, ErrorT, false>&& other) EELS_NOEXCEPT_IF((std::is_nothrow_move_constructible<ValueT>::value && std::is_nothrow_move_constructible<ErrorT>::value))
+		: base_type(uninitialized_storage_t())
+	{
+		base_type::construct_from(std::move(other));
+	}
+
+	move_constructible_storage<ValueT, ErrorT, false>& operator=(const move_constructible_storage<ValueT, ErrorT, false>&) = default;
+#if defined(EELS_NO_CXX11_DEFAULTED_MOVE)
+	move_constructible_storage<ValueT, ErrorT, false>& operator=(move_constructible_storage<ValueT, ErrorT, false>&& other)
+	{
+		base_type::operator=(std::move(other));
+		return *this;
+	}
+#else
+	move_constructible_storage<ValueT, ErrorT, false>& operator=(move_constructible_storage<ValueT, ErrorT, false>&&) = default;
+#endif // EELS_NO_CXX11_DEFAULTED_MOVE
+};
+
+template<typename ValueT, typename ErrorT,
+		 bool TrivialV = std::is_trivially_destructible<ValueT>::value && std::is_trivially_destructible<ErrorT>::value>
+class destructible_storage
+	: public move_constructible_storage<ValueT, ErrorT>
+{
+private:
+	typedef move_constructible_storage<ValueT, ErrorT> base_type;
+
+public:
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR destructible_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
+};
+
+template<typename ValueT, typename ErrorT>
+class destructible_storage<ValueT, ErrorT, false>
+	: public move_constructible_storage<ValueT, ErrorT>
+{
+private:
+	typedef move_constructible_storage<ValueT, ErrorT> base_type;
+
+public:
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR destructible_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
+
+	destructible_storage(const destructible_storage<ValueT, ErrorT, false>&) = default;
+	destructible_storage<ValueT, ErrorT, false>& operator=(const destructible_storage<ValueT, ErrorT, false>&) = default;
+#if defined(EELS_NO_CXX11_DEFAULTED_MOVE)
+	destructible_storage(destructible_storage<ValueT, ErrorT, false>&& other)
+		: base_type(std::move(other))
+	{ }
+	destructible_storage<ValueT, ErrorT, false>& operator=(destructible_storage<ValueT, ErrorT, false>&& other)
+	{
+		base_type::operator=(std::move(other));
+		return *this;
+	}
+#else
+	destructible_storage(destructible_storage<ValueT, ErrorT, false>&&) = default;
+	destructible_storage<ValueT, ErrorT, false>& operator=(destructible_storage<ValueT, ErrorT, false>&&) = default;
+#endif // EELS_NO_CXX11_DEFAULTED_MOVE
+
+	~destructible_storage()
+	{
+		base_type::destroy();
 	}
+};
+
+template<typename ValueT, typename ErrorT,
+		 bool TrivialV = allow_trivial_storage && std::is_trivially_copy_constructible<ValueT>::value && std::is_trivially_copy_assignable<ValueT>::value && std::is_trivially_destructible<ValueT>::value &&
+						 std::is_trivially_copy_constructible<ErrorT>::value && std::is_trivially_copy_assignable<ErrorT>::value && std::is_trivially_destructible<ErrorT>::value>
+class copy_assignable_storage
+	: public destructible_storage<ValueT, ErrorT>
+{
+private:
+	typedef destructible_storage<ValueT, ErrorT> base_type;
+
+public:
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR copy_assignable_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
+};
+
+template<typename ValueT, typename ErrorT>
+class copy_assignable_storage<ValueT, ErrorT, false>
+	: public destructible_storage<ValueT, ErrorT>
+{
+private:
+	typedef destructible_storage<ValueT, ErrorT> base_type;
+
+public:
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR copy_assignable_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
 
-    nontrivial_storage<value_type, error_type>& operator=(const nontrivial_storage<value_type, error_type>& other)
-    {
-        base_type::operator=(other);
-        return *this;
-    }
-
-    nontrivial_storage<value_type, error_type>& operator=(nontrivial_storage<value_type, error_type>&& other)
-    {
-        base_type::operator=(std::move(other));
-        return *this;
-    }
-
-    nontrivial_storage<value_type, error_type>& operator=(const value_type& val)
-    {
-        base_type::operator=(val);
-        return *this;
-    }
-
-    nontrivial_storage<value_type, error_type>& operator=(value_type&& val)
-    {
-        base_type::operator=(std::move(val));
-        return *this;
-    }
-
-    template<typename... ArgsT, std::size_t... Indices>
-    nontrivial_storage<value_type, error_type>& assign(std::tuple<ArgsT...>&& factory, const tuple_indices<Indices...>&)
-    {
-        base_type::assign(std::forward<ArgsT>(std::get<Indices>(factory))...);
-        return *this;
-    }
+	copy_assignable_storage(const copy_assignable_storage<ValueT, ErrorT, false>&) = default;
+
+	copy_assignable_storage<ValueT, ErrorT, false>& operator=(const copy_assignable_storage<ValueT, ErrorT, false>& other) EELS_NOEXCEPT_IF((std::is_nothrow_copy_assignable<ValueT>::value && std::is_nothrow_copy_constructible<ValueT>::value && std::is_nothrow_destructible<ValueT>::value && std::is_nothrow_copy_assignable<ErrorT>::value && std::is_nothrow_copy_constructible<ErrorT>::value && std::is_nothrow_destructible<ErrorT>::value))
+	{
+		base_type::assign_from(other);
+		return *this;
+	}
+
+#if defined(EELS_NO_CXX11_DEFAULTED_MOVE)
+	copy_assignable_storage(copy_assignable_storage<ValueT, ErrorT, false>&& other)
+		: base_type(std::move(other))
+	{ }
+	copy_assignable_storage<ValueT, ErrorT, false>& operator=(copy_assignable_storage<ValueT, ErrorT, false>&& other)
+	{
+		base_type::operator=(std::move(other));
+		return *this;
+	}
+#else
+	copy_assignable_storage(copy_assignable_storage<ValueT, ErrorT, false>&&) = default;
+	copy_assignable_storage<ValueT, ErrorT, false>& operator=(copy_assignable_storage<ValueT, ErrorT, false>&&) = default;
+#endif // EELS_NO_CXX11_DEFAULTED_MOVE
+};
+
+template<typename ValueT, typename ErrorT,
+		 bool TrivialV = allow_trivial_storage && std::is_trivially_move_constructible<ValueT>::value && std::is_trivially_move_assignable<ValueT>::value && std::is_trivially_destructible<ValueT>::value &&
+						 std::is_trivially_move_constructible<ErrorT>::value && std::is_trivially_move_assignable<ErrorT>::value && std::is_trivially_destructible<ErrorT>::value>
+class move_assignable_storage
+	: public copy_assignable_storage<ValueT, ErrorT>
+{
+private:
+	typedef copy_assignable_storage<ValueT, ErrorT> base_type;
+
+public:
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR move_assignable_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
+};
+
+template<typename ValueT, typename ErrorT>
+class move_assignable_storage<ValueT, ErrorT, false>
+	: public copy_assignable_storage<ValueT, ErrorT>
+{
+private:
+	typedef copy_assignable_storage<ValueT, ErrorT> base_type;
+
+public:
+	template<typename... ArgsT, typename = typename std::enable_if<!is_storage_argument<storage_base<ValueT, ErrorT>, ArgsT...>::value>::type>
+	EELS_CXX14_CONSTEXPR move_assignable_storage(ArgsT&&... args)
+		: base_type(std::forward<ArgsT>(args)...)
+	{ }
+
+	move_assignable_storage(const move_assignable_storage<ValueT, ErrorT, false>&) = default;
+#if defined(EELS_NO_CXX11_DEFAULTED_MOVE)
+	move_assignable_storage(move_assignable_storage<ValueT, ErrorT, false>&& other)
+		: base_type(std::move(other))
+	{ }
+#else
+	move_assignable_storage(move_assignable_storage<ValueT, ErrorT, false>&&) = default;
+#endif // EELS_NO_CXX11_DEFAULTED_MOVE
+	move_assignable_storage<ValueT, ErrorT, false>& operator=(const move_assignable_storage<ValueT, ErrorT, false>&) = default;
+
+	move_assignable_storage<ValueT, ErrorT, false>& operator=(move_assignable_storage<ValueT, ErrorT, false>&& other) EELS_NOEXCEPT_IF((std::is_nothrow_move_assignable<ValueT>::value && std::is_nothrow_move_constructible<ValueT>::value && std::is_nothrow_destructible<ValueT>::value && std::is_nothrow_move_assignable<ErrorT>::value && std::is_nothrow_move_constructible<ErrorT>::value && std::is_nothrow_destructible<ErrorT>::value))
+	{
+		base_type::assign_from(std::move(other));
+		return *this;
+	}
 };
 
 template<typename ValueT, typename ErrorT>
@@ -398,12 +630,18 @@ public:
 	typedef ValueT value_type;
 	typedef ErrorT error_type;
 	typedef typename std::conditional<
-							std::is_trivially_destructible<value_type>::value && std::is_trivially_destructible<error_type>::value,
+							allow_trivial_storage &&
+							std::is_trivially_copy_constructible<value_type>::value && std::is_trivially_move_constructible<value_type>::value &&
+							std::is_trivially_copy_assignable<value_type>::value && std::is_trivially_move_assignable<value_type>::value &&
+							std::is_trivially_destructible<value_type>::value &&
+							std::is_trivially_copy_constructible<error_type>::value && std::is_trivially_move_constructible<error_type>::value &&
+							std::is_trivially_copy_assignable<error_type>::value && std::is_trivially_move_assignable<error_type>::value &&
+							std::is_trivially_destructible<error_type>::value,
 						trivial_storage<value_type, error_type>,
-						nontrivial_storage<value_type, error_type>
+						move_assignable_storage<value_type, error_type>
 	>::type type;
 };
 
 } } }
 
-#endif // EELS_EXPECTED_DETAIL_STORAGE_H_
\ No newline at end of file
+#endif // EELS_EXPECTED_DETAIL_STORAGE_H_
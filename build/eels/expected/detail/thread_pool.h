@@ -0,0 +1,155 @@
+#ifndef EELS_EXPECTED_DETAIL_THREAD_POOL_H_
+#define EELS_EXPECTED_DETAIL_THREAD_POOL_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <eels/config.h>
+
+#if defined(EELS_USE_PARALLEL_ALGORITHMS)
+#include <execution>
+#endif
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 { namespace detail {
+#else
+namespace eels { inline namespace expected_v1 { namespace detail {
+#endif
+
+// Workers running copies of a job alongside the thread that submits it.
+// A job shares its work between its copies itself, so the submitting thread can simply run it too:
+// once it returns, copies no worker has picked up yet are withdrawn instead of waited for,
+// which also keeps nested jobs from waiting on workers that are all busy.
+class thread_pool
+{
+public:
+    static thread_pool& instance()
+    {
+        static thread_pool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+        return pool;
+    }
+
+    explicit thread_pool(std::size_t workers)
+        : stopping_(false)
+    {
+        workers_.reserve(workers);
+        for(std::size_t i = 0; i < workers; ++i)
+            workers_.push_back(std::thread(&thread_pool::work, this));
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for(std::vector<std::thread>::iterator it = workers_.begin(); it != workers_.end(); ++it)
+            it->join();
+    }
+
+    std::size_t size() const { return workers_.size(); }
+
+    // Runs 'job' on the calling thread and on up to 'helpers' workers, returns once every copy started is done.
+    // 'job' must not throw.
+    template<typename JobT>
+    void run(std::size_t helpers, JobT& job)
+    {
+        batch b(&invoke<JobT>, &job);
+        helpers = std::min(helpers, workers_.size());
+        if(helpers)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.insert(queue_.end(), helpers, &b);
+            }
+            wake_.notify_all();
+        }
+
+        job();
+
+        if(helpers)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queue_.erase(std::remove(queue_.begin(), queue_.end(), &b), queue_.end());
+            while(b.running)
+                b.done.wait(lock);
+        }
+    }
+
+private:
+    thread_pool(const thread_pool&);
+    thread_pool& operator=(const thread_pool&);
+
+    class batch
+    {
+    public:
+        batch(void (*execute)(void*), void* job) : execute(execute), job(job), running(0) { }
+
+        void (*execute)(void*);
+        void* job;
+        std::size_t running;
+        std::condition_variable done;
+    };
+
+    template<typename JobT>
+    static void invoke(void* job) { (*static_cast<JobT*>(job))(); }
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for(;;)
+        {
+            while(!stopping_ && queue_.empty())
+                wake_.wait(lock);
+            if(queue_.empty())
+                return;
+
+            batch* b = queue_.front();
+            queue_.pop_front();
+            ++b->running;
+            lock.unlock();
+            b->execute(b->job);
+            lock.lock();
+            if(--b->running == 0)
+                b->done.notify_all();
+        }
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::deque<batch*> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+};
+
+// Runs 'job' on 'participants' threads, the calling one included.
+template<typename JobT>
+void run_parallel(std::size_t participants, JobT& job)
+{
+#if defined(EELS_USE_PARALLEL_ALGORITHMS)
+    std::vector<std::size_t> lanes(participants);
+    std::for_each(std::execution::par, lanes.begin(), lanes.end(), [&job](std::size_t) { job(); });
+#else
+    thread_pool::instance().run(participants - 1, job);
+#endif
+}
+
+// Number of threads that can run a job at once.
+inline std::size_t max_participants()
+{
+#if defined(EELS_USE_PARALLEL_ALGORITHMS)
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+#else
+    return thread_pool::instance().size() + 1;
+#endif
+}
+
+} } }
+
+#endif // EELS_EXPECTED_DETAIL_THREAD_POOL_H_
@@ -4,7 +4,9 @@
 #include <tuple>
 #include <utility>
 #include <eels/config.h>
+#include <eels/expected/status.h>
 #include <eels/expected/tags.h>
+#include <eels/expected/detail/pipeline.h>
 #include <eels/expected/detail/storage.h>
 #include <eels/expected/detail/tuple_indices.h>
 
@@ -14,7 +16,7 @@ namespace eels { namespace expected_v1 {
 namespace eels { inline namespace expected_v1 {
 #endif
 
-template<typename ValueT, typename ErrorT>
+template<typename ValueT, typename ErrorT = status>
 class expected
 {
 public:
@@ -26,6 +28,7 @@ public:
         : storage_()
 	{ }
 
+#if defined(EELS_NO_CXX11_DEFAULTED_MOVE)
 	EELS_CXX14_CONSTEXPR expected(const expected<value_type, error_type>& other) EELS_NOEXCEPT_IF((std::is_nothrow_copy_constructible<value_type>::value && std::is_nothrow_copy_constructible<error_type>::value))
 		: storage_(other.storage_)
 	{ }
@@ -33,6 +36,11 @@ public:
 	EELS_CXX14_CONSTEXPR expected(expected<value_type, error_type>&& other) EELS_NOEXCEPT_IF((std::is_nothrow_move_constructible<value_type>::value && std::is_nothrow_move_constructible<error_type>::value))
 		: storage_(std::move(other.storage_))
 	{ }
+#else
+	// trivial whenever the value and error types allow it
+	EELS_CXX14_CONSTEXPR expected(const expected<value_type, error_type>&) = default;
+	EELS_CXX14_CONSTEXPR expected(expected<value_type, error_type>&&) = default;
+#endif // EELS_NO_CXX11_DEFAULTED_MOVE
 
 	EELS_CXX14_CONSTEXPR expected(const value_type& val) EELS_NOEXCEPT_IF((std::is_nothrow_copy_constructible<value_type>::value))
 		: storage_(val)
@@ -48,7 +56,7 @@ public:
 	{ }
 
     template<typename... ArgsT>
-    EELS_CXX14_CONSTEXPR expected(std::tuple<in_place_t&, ArgsT...>&& factory) EELS_NOEXCEPT_IF((std::is_nothrow_constructible<value_type, ArgsT...>::value))
+    EELS_CXX14_CONSTEXPR expected(std::tuple<const in_place_t&, ArgsT...>&& factory) EELS_NOEXCEPT_IF((std::is_nothrow_constructible<value_type, ArgsT...>::value))
         : storage_(std::move(factory), detail::make_tuple_indices(factory))
     { }
     
@@ -58,10 +66,11 @@ public:
 	{ }
 
     template<typename... ArgsT>
-    EELS_CXX14_CONSTEXPR expected(std::tuple<unexpected_t&, ArgsT...> factory) EELS_NOEXCEPT_IF((std::is_nothrow_constructible<value_type, ArgsT...>::value))
+    EELS_CXX14_CONSTEXPR expected(std::tuple<const unexpected_t&, ArgsT...>&& factory) EELS_NOEXCEPT_IF((std::is_nothrow_constructible<error_type, ArgsT...>::value))
         : storage_(std::move(factory), detail::make_tuple_indices(factory))
     { }
 
+#if defined(EELS_NO_CXX11_DEFAULTED_MOVE)
     expected<value_type, error_type>& operator=(const expected<value_type, error_type>& other) EELS_NOEXCEPT_IF((std::is_nothrow_copy_assignable<value_type>::value && std::is_nothrow_copy_constructible<value_type>::value && std::is_nothrow_destructible<value_type>::value && std::is_nothrow_copy_assignable<error_type>::value && std::is_nothrow_copy_constructible<error_type>::value && std::is_nothrow_destructible<error_type>::value))
 	{
 		storage_ = other.storage_;
@@ -73,33 +82,49 @@ public:
 		storage_ = std::move(other.storage_);
 		return *this;
 	}
+#else
+    expected<value_type, error_type>& operator=(const expected<value_type, error_type>&) = default;
+    expected<value_type, error_type>& operator=(expected<value_type, error_type>&&) = default;
+#endif // EELS_NO_CXX11_DEFAULTED_MOVE
 
     expected<value_type, error_type>& operator=(const value_type& val) EELS_NOEXCEPT_IF((std::is_nothrow_copy_assignable<value_type>::value && std::is_nothrow_copy_constructible<value_type>::value && std::is_nothrow_destructible<error_type>::value))
     {
-        storage_ = val;
+        storage_.assign(val);
         return *this;
     }
 
     expected<value_type, error_type>& operator=(value_type&& val) EELS_NOEXCEPT_IF((std::is_nothrow_move_assignable<value_type>::value && std::is_nothrow_move_constructible<value_type>::value && std::is_nothrow_destructible<error_type>::value))
     {
-        storage_ = std::move(val);
+        storage_.assign(std::move(val));
         return *this;
     }
 
     template<typename... ArgsT>
-    expected<value_type, error_type>& operator=(std::tuple<in_place_t&, ArgsT...>&& factory) EELS_NOEXCEPT_IF((std::is_nothrow_move_assignable<value_type>::value && std::is_nothrow_constructible<value_type, ArgsT...>::value && std::is_nothrow_destructible<error_type>::value))
+    expected<value_type, error_type>& operator=(std::tuple<const in_place_t&, ArgsT...>&& factory) EELS_NOEXCEPT_IF((std::is_nothrow_move_assignable<value_type>::value && std::is_nothrow_constructible<value_type, ArgsT...>::value && std::is_nothrow_destructible<error_type>::value))
     {
         storage_.assign(std::move(factory), detail::make_tuple_indices(factory));
         return *this;
     }
 
     template<typename... ArgsT>
-    expected<value_type, error_type>& operator=(std::tuple<unexpected_t&, ArgsT...>&& factory) EELS_NOEXCEPT_IF((std::is_nothrow_move_assignable<error_type>::value && std::is_nothrow_constructible<error_type, ArgsT...>::value && std::is_nothrow_destructible<value_type>::value))
+    expected<value_type, error_type>& operator=(std::tuple<const unexpected_t&, ArgsT...>&& factory) EELS_NOEXCEPT_IF((std::is_nothrow_move_assignable<error_type>::value && std::is_nothrow_constructible<error_type, ArgsT...>::value && std::is_nothrow_destructible<value_type>::value))
     {
         storage_.assign(std::move(factory), detail::make_tuple_indices(factory));
         return *this;
     }
 
+    template<typename... ArgsT>
+    value_type& emplace(ArgsT&&... args) EELS_NOEXCEPT_IF((std::is_nothrow_constructible<value_type, ArgsT...>::value && std::is_nothrow_destructible<value_type>::value && std::is_nothrow_destructible<error_type>::value))
+    {
+        return storage_.emplace(in_place, std::forward<ArgsT>(args)...);
+    }
+
+    template<typename... ArgsT>
+    error_type& emplace_error(ArgsT&&... args) EELS_NOEXCEPT_IF((std::is_nothrow_constructible<error_type, ArgsT...>::value && std::is_nothrow_destructible<value_type>::value && std::is_nothrow_destructible<error_type>::value))
+    {
+        return storage_.emplace(unexpected, std::forward<ArgsT>(args)...);
+    }
+
     EELS_CXX11_CONSTEXPR operator bool() const { return storage_.valid(); }
     EELS_CXX11_CONSTEXPR bool operator!() const { return !storage_.valid(); }
 
@@ -124,20 +149,80 @@ public:
     EELS_CXX11_CONSTEXPR error_type&& error() && { return std::move(storage_).error(); }
 #endif // EELS_REFQUALIFIERS
 
+    // Monadic operations: each builds the resulting expected directly from the value or error.
+    // Chaining several of them constructs an expected per call, see 'pipeline.h' to fuse them into a single one.
+#if defined(EELS_NO_CXX11_REF_QUALIFIERS)
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_t, expected<value_type, error_type>&, FunctionT>::type map(FunctionT&& function) { return detail::apply_stage<detail::map_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_t, const expected<value_type, error_type>&, FunctionT>::type map(FunctionT&& function) const { return detail::apply_stage<detail::map_t>(*this, function); }
+
+    template<typename FunctionT>
+    typename detail::stage_result<detail::and_then_t, expected<value_type, error_type>&, FunctionT>::type and_then(FunctionT&& function) { return detail::apply_stage<detail::and_then_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::and_then_t, const expected<value_type, error_type>&, FunctionT>::type and_then(FunctionT&& function) const { return detail::apply_stage<detail::and_then_t>(*this, function); }
+
+    template<typename FunctionT>
+    typename detail::stage_result<detail::or_else_t, expected<value_type, error_type>&, FunctionT>::type or_else(FunctionT&& function) { return detail::apply_stage<detail::or_else_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::or_else_t, const expected<value_type, error_type>&, FunctionT>::type or_else(FunctionT&& function) const { return detail::apply_stage<detail::or_else_t>(*this, function); }
+
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_error_t, expected<value_type, error_type>&, FunctionT>::type map_error(FunctionT&& function) { return detail::apply_stage<detail::map_error_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_error_t, const expected<value_type, error_type>&, FunctionT>::type map_error(FunctionT&& function) const { return detail::apply_stage<detail::map_error_t>(*this, function); }
+
+    template<typename DefaultT>
+    value_type value_or(DefaultT&& def) const { return storage_.valid() ? storage_.value() : static_cast<value_type>(std::forward<DefaultT>(def)); }
+#else
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_t, expected<value_type, error_type>&, FunctionT>::type map(FunctionT&& function) & { return detail::apply_stage<detail::map_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_t, const expected<value_type, error_type>&, FunctionT>::type map(FunctionT&& function) const& { return detail::apply_stage<detail::map_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_t, expected<value_type, error_type>&&, FunctionT>::type map(FunctionT&& function) && { return detail::apply_stage<detail::map_t>(std::move(*this), function); }
+
+    template<typename FunctionT>
+    typename detail::stage_result<detail::and_then_t, expected<value_type, error_type>&, FunctionT>::type and_then(FunctionT&& function) & { return detail::apply_stage<detail::and_then_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::and_then_t, const expected<value_type, error_type>&, FunctionT>::type and_then(FunctionT&& function) const& { return detail::apply_stage<detail::and_then_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::and_then_t, expected<value_type, error_type>&&, FunctionT>::type and_then(FunctionT&& function) && { return detail::apply_stage<detail::and_then_t>(std::move(*this), function); }
+
+    template<typename FunctionT>
+    typename detail::stage_result<detail::or_else_t, expected<value_type, error_type>&, FunctionT>::type or_else(FunctionT&& function) & { return detail::apply_stage<detail::or_else_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::or_else_t, const expected<value_type, error_type>&, FunctionT>::type or_else(FunctionT&& function) const& { return detail::apply_stage<detail::or_else_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::or_else_t, expected<value_type, error_type>&&, FunctionT>::type or_else(FunctionT&& function) && { return detail::apply_stage<detail::or_else_t>(std::move(*this), function); }
+
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_error_t, expected<value_type, error_type>&, FunctionT>::type map_error(FunctionT&& function) & { return detail::apply_stage<detail::map_error_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_error_t, const expected<value_type, error_type>&, FunctionT>::type map_error(FunctionT&& function) const& { return detail::apply_stage<detail::map_error_t>(*this, function); }
+    template<typename FunctionT>
+    typename detail::stage_result<detail::map_error_t, expected<value_type, error_type>&&, FunctionT>::type map_error(FunctionT&& function) && { return detail::apply_stage<detail::map_error_t>(std::move(*this), function); }
+
+    template<typename DefaultT>
+    value_type value_or(DefaultT&& def) const& { return storage_.valid() ? storage_.value() : static_cast<value_type>(std::forward<DefaultT>(def)); }
+    template<typename DefaultT>
+    value_type value_or(DefaultT&& def) && { return storage_.valid() ? std::move(storage_).value() : static_cast<value_type>(std::forward<DefaultT>(def)); }
+#endif // EELS_REFQUALIFIERS
+
 private:
 	typename detail::storage_selector<value_type, error_type>::type storage_;
 };
 
 template<typename... ArgsT>
-std::tuple<in_place_t&, ArgsT&&...> make_expected(ArgsT&&... args)
+std::tuple<const in_place_t&, ArgsT&&...> make_expected(ArgsT&&... args)
 {
-    return std::forward_as_tuple(in_place, std::forward<ArgsT>(args)...);
+    return std::tuple<const in_place_t&, ArgsT&&...>(in_place, std::forward<ArgsT>(args)...);
 }
 
 template<typename... ArgsT>
-std::tuple<unexpected_t&, ArgsT&&...> make_unexpected(ArgsT&&... args)
-{    
-    return std::forward_as_tuple(unexpected, std::forward<ArgsT>(args)...);
+std::tuple<const unexpected_t&, ArgsT&&...> make_unexpected(ArgsT&&... args)
+{
+    return std::tuple<const unexpected_t&, ArgsT&&...>(unexpected, std::forward<ArgsT>(args)...);
 }
 
 } }
@@ -0,0 +1,302 @@
+#ifndef EELS_EXPECTED_EXPECTED_VECTOR_H_
+#define EELS_EXPECTED_EXPECTED_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <eels/config.h>
+#include <eels/expected/expected.h>
+#include <eels/expected/tags.h>
+#include <eels/expected/detail/bitset.h>
+#include <eels/expected/detail/tuple_indices.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 {
+#else
+namespace eels { inline namespace expected_v1 {
+#endif
+
+// Contiguous elements owned by someone else.
+template<typename T>
+class span
+{
+public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef std::size_t size_type;
+
+    EELS_CXX11_CONSTEXPR span() : data_(nullptr), size_(0) { }
+    EELS_CXX11_CONSTEXPR span(T* data, size_type size) : data_(data), size_(size) { }
+
+    EELS_CXX11_CONSTEXPR T* data() const { return data_; }
+    EELS_CXX11_CONSTEXPR size_type size() const { return size_; }
+    EELS_CXX11_CONSTEXPR bool empty() const { return size_ == 0; }
+
+    EELS_CXX11_CONSTEXPR iterator begin() const { return data_; }
+    EELS_CXX11_CONSTEXPR iterator end() const { return data_ + size_; }
+
+    EELS_CXX11_CONSTEXPR T& operator[](size_type index) const { return data_[index]; }
+
+private:
+    T* data_;
+    size_type size_;
+};
+
+// Proxy to an element of an 'expected_vector', used like an 'expected'.
+// Its state cannot be changed, but the value or error it refers to can.
+template<typename ValueT, typename ErrorT>
+class expected_reference
+{
+public:
+    typedef ValueT value_type;
+    typedef ErrorT error_type;
+
+    expected_reference(value_type* val, error_type* err) : value_(val), error_(err) { }
+
+    template<typename OtherValueT, typename OtherErrorT>
+    expected_reference(const expected_reference<OtherValueT, OtherErrorT>& other) : value_(other.value_), error_(other.error_) { }
+
+    operator bool() const { return value_ != nullptr; }
+    bool operator!() const { return value_ == nullptr; }
+
+    value_type* operator->() const { assert(value_); return value_; }
+    value_type& operator*() const { assert(value_); return *value_; }
+    error_type& error() const { assert(error_); return *error_; }
+
+    template<typename DefaultT>
+    typename std::remove_const<value_type>::type value_or(DefaultT&& def) const { return value_ ? *value_ : static_cast<typename std::remove_const<value_type>::type>(std::forward<DefaultT>(def)); }
+
+    operator expected<typename std::remove_const<value_type>::type, typename std::remove_const<error_type>::type>() const
+    {
+        typedef expected<typename std::remove_const<value_type>::type, typename std::remove_const<error_type>::type> expected_type;
+        return value_ ? expected_type(in_place, *value_) : expected_type(unexpected, *error_);
+    }
+
+private:
+    template<typename OtherValueT, typename OtherErrorT>
+    friend class expected_reference;
+
+    value_type* value_;
+    error_type* error_;
+};
+
+// Sequence of 'expected<ValueT, ErrorT>' stored as a structure of arrays:
+// values and errors each live densely in their own array, in the order they were added,
+// and a packed bitset tells which elements are valid.
+// The position of an element in its array is the number of elements of the same kind before it,
+// found in constant time thanks to 'ranks_', which holds the number of valid elements before each word of the bitset.
+// The ranks live apart from the bitset so that scans read its words contiguously.
+template<typename ValueT, typename ErrorT>
+class expected_vector
+{
+public:
+    typedef ValueT value_type;
+    typedef ErrorT error_type;
+    typedef std::size_t size_type;
+    typedef expected_reference<value_type, error_type> reference;
+    typedef expected_reference<const value_type, const error_type> const_reference;
+
+    // 'std::vector<bool>' packs its elements, which cannot then be referred to or viewed as a span.
+    static_assert(!std::is_same<typename std::remove_cv<value_type>::type, bool>::value, "'expected_vector' cannot store bool values, wrap them in a class or use 'unsigned char'.");
+    static_assert(!std::is_same<typename std::remove_cv<error_type>::type, bool>::value, "'expected_vector' cannot store bool errors, wrap them in a class or use 'unsigned char'.");
+
+    // The elements of each kind, in order.
+    class partition_type
+    {
+    public:
+        partition_type(span<const value_type> vals, span<const error_type> errs) : values(vals), errors(errs) { }
+
+        span<const value_type> values;
+        span<const error_type> errors;
+    };
+
+public:
+    size_type size() const { return values_.size() + errors_.size(); }
+    bool empty() const { return size() == 0; }
+
+    void reserve(size_type count)
+    {
+        validity_.reserve((count + detail::bits_per_word - 1) / detail::bits_per_word);
+        ranks_.reserve((count + detail::bits_per_word - 1) / detail::bits_per_word);
+        values_.reserve(count);
+    }
+
+    void clear()
+    {
+        values_.clear();
+        errors_.clear();
+        validity_.clear();
+        ranks_.clear();
+    }
+
+    void push_back(const expected<value_type, error_type>& e)
+    {
+        if(e)
+            append_value(*e);
+        else
+            append_error(e.error());
+    }
+
+    void push_back(expected<value_type, error_type>&& e)
+    {
+        if(e)
+            append_value(std::move(*e));
+        else
+            append_error(std::move(e.error()));
+    }
+
+    template<typename... ArgsT>
+    void push_back(std::tuple<const in_place_t&, ArgsT...>&& factory) { emplace_from(std::move(factory), detail::make_tuple_indices(factory)); }
+
+    template<typename... ArgsT>
+    void push_back(std::tuple<const unexpected_t&, ArgsT...>&& factory) { emplace_from(std::move(factory), detail::make_tuple_indices(factory)); }
+
+    template<typename... ArgsT>
+    reference emplace_back(in_place_t, ArgsT&&... args) { append_value(std::forward<ArgsT>(args)...); return back(); }
+
+    template<typename... ArgsT>
+    reference emplace_back(unexpected_t, ArgsT&&... args) { append_error(std::forward<ArgsT>(args)...); return back(); }
+
+    template<typename... ArgsT>
+    reference emplace_back(std::tuple<const in_place_t&, ArgsT...>&& factory) { return emplace_from(std::move(factory), detail::make_tuple_indices(factory)); }
+
+    template<typename... ArgsT>
+    reference emplace_back(std::tuple<const unexpected_t&, ArgsT...>&& factory) { return emplace_from(std::move(factory), detail::make_tuple_indices(factory)); }
+
+    reference operator[](size_type index)
+    {
+        assert(index < size());
+        return valid(index) ? reference(&values_[value_position(index)], nullptr) : reference(nullptr, &errors_[index - value_position(index)]);
+    }
+
+    const_reference operator[](size_type index) const
+    {
+        assert(index < size());
+        return valid(index) ? const_reference(&values_[value_position(index)], nullptr) : const_reference(nullptr, &errors_[index - value_position(index)]);
+    }
+
+    reference back() { return (*this)[size() - 1]; }
+    const_reference back() const { return (*this)[size() - 1]; }
+
+    size_type count_errors() const { return errors_.size(); }
+    size_type count_errors(size_type first, size_type last) const
+    {
+        assert(first <= last && last <= size());
+        return (last - first) - detail::count_ones(validity_.data(), first, last);
+    }
+
+    bool all_valid() const { return errors_.empty(); }
+    bool all_valid(size_type first, size_type last) const
+    {
+        assert(first <= last && last <= size());
+        return detail::find_first_zero(validity_.data(), first, last) == last;
+    }
+
+    // Index of the first error at or after 'from', or 'size()'.
+    size_type first_error(size_type from = 0) const
+    {
+        assert(from <= size());
+        return detail::find_first_zero(validity_.data(), from, size());
+    }
+
+    partition_type partition() const
+    {
+        return partition_type(span<const value_type>(values_.data(), values_.size()), span<const error_type>(errors_.data(), errors_.size()));
+    }
+
+private:
+    bool valid(size_type index) const
+    {
+        return (validity_[index / detail::bits_per_word] >> (index % detail::bits_per_word)) & 1;
+    }
+
+    // number of valid elements before 'index'
+    size_type value_position(size_type index) const
+    {
+        const size_type word = index / detail::bits_per_word;
+        const size_type bit = index % detail::bits_per_word;
+        return ranks_[word] + (bit ? detail::popcount(validity_[word] & detail::low_bits(bit)) : 0);
+    }
+
+    // Makes room in the bitset for one more element, returns whether a word was added.
+    bool grow_bitset()
+    {
+        if(size() % detail::bits_per_word)
+            return false;
+        validity_.push_back(0);
+        try
+        {
+            ranks_.push_back(values_.size());
+        }
+        catch(...)
+        {
+            validity_.pop_back();
+            throw;
+        }
+        return true;
+    }
+
+    void shrink_bitset(bool word_added)
+    {
+        if(!word_added)
+            return;
+        validity_.pop_back();
+        ranks_.pop_back();
+    }
+
+    template<typename... ArgsT>
+    void append_value(ArgsT&&... args)
+    {
+        const size_type index = size();
+        const bool word_added = grow_bitset();
+        try
+        {
+            values_.emplace_back(std::forward<ArgsT>(args)...);
+        }
+        catch(...)
+        {
+            shrink_bitset(word_added);
+            throw;
+        }
+        validity_[index / detail::bits_per_word] |= std::uint64_t(1) << (index % detail::bits_per_word);
+    }
+
+    template<typename... ArgsT>
+    void append_error(ArgsT&&... args)
+    {
+        const bool word_added = grow_bitset();
+        try
+        {
+            errors_.emplace_back(std::forward<ArgsT>(args)...);
+        }
+        catch(...)
+        {
+            shrink_bitset(word_added);
+            throw;
+        }
+    }
+
+    template<typename... ArgsT, std::size_t... Indices>
+    reference emplace_from(std::tuple<ArgsT...>&& factory, const detail::tuple_indices<Indices...>&)
+    {
+        return emplace_back(std::forward<ArgsT>(std::get<Indices>(factory))...);
+    }
+
+private:
+    std::vector<value_type> values_;
+    std::vector<error_type> errors_;
+    std::vector<std::uint64_t> validity_;
+    std::vector<size_type> ranks_;      // number of valid elements before each word of 'validity_'
+};
+
+} }
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { using namespace expected_v1; }
+#endif
+
+#endif // EELS_EXPECTED_EXPECTED_VECTOR_H_
@@ -0,0 +1,96 @@
+#ifndef EELS_EXPECTED_INSTRUMENTATION_H_
+#define EELS_EXPECTED_INSTRUMENTATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <eels/config.h>
+#include <eels/expected/detail/instrumentation.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 {
+#else
+namespace eels { inline namespace expected_v1 {
+#endif
+
+// What expected objects did, counted when EELS_EXPECTED_INSTRUMENT is defined and all zeros otherwise.
+class expected_counters
+{
+public:
+    expected_counters()
+        : constructions(0), error_constructions(0), value_to_error_switches(0), error_to_value_switches(0), copies(0), moves(0) { }
+
+    std::uint64_t constructions;            // objects constructed, whatever their state
+    std::uint64_t error_constructions;      // objects constructed with an error
+    std::uint64_t value_to_error_switches;  // assignments that replaced a value with an error
+    std::uint64_t error_to_value_switches;  // assignments that replaced an error with a value
+    std::uint64_t copies;                   // copy constructions and assignments
+    std::uint64_t moves;                    // move constructions and assignments
+};
+
+// Counts between two snapshots.
+inline expected_counters operator-(const expected_counters& after, const expected_counters& before)
+{
+    expected_counters result;
+    result.constructions = after.constructions - before.constructions;
+    result.error_constructions = after.error_constructions - before.error_constructions;
+    result.value_to_error_switches = after.value_to_error_switches - before.value_to_error_switches;
+    result.error_to_value_switches = after.error_to_value_switches - before.error_to_value_switches;
+    result.copies = after.copies - before.copies;
+    result.moves = after.moves - before.moves;
+    return result;
+}
+
+#if defined(EELS_EXPECTED_INSTRUMENT)
+
+namespace detail {
+
+inline expected_counters make_counters(const std::uint64_t (&counts)[counter_count])
+{
+    expected_counters result;
+    result.constructions = counts[construction_counter];
+    result.error_constructions = counts[error_construction_counter];
+    result.value_to_error_switches = counts[value_to_error_counter];
+    result.error_to_value_switches = counts[error_to_value_counter];
+    result.copies = counts[copy_counter];
+    result.moves = counts[move_counter];
+    return result;
+}
+
+} // namespace detail
+
+#endif
+
+// Counts of every thread so far, those that exited included.
+// Threads still running may be counting while this is read, each counter is exact but they are not read at the same instant.
+inline expected_counters expected_counters_snapshot()
+{
+#if !defined(EELS_EXPECTED_INSTRUMENT)
+    return expected_counters();
+#else
+    std::uint64_t totals[detail::counter_count];
+    detail::counter_registry::instance().sum(totals);
+    return detail::make_counters(totals);
+#endif
+}
+
+// Counts of the calling thread so far.
+inline expected_counters thread_expected_counters()
+{
+#if !defined(EELS_EXPECTED_INSTRUMENT)
+    return expected_counters();
+#else
+    const detail::counter_block& block = detail::local_counters();
+    std::uint64_t totals[detail::counter_count];
+    for(std::size_t i = 0; i < detail::counter_count; ++i)
+        totals[i] = block.counts[i].load(std::memory_order_relaxed);
+    return detail::make_counters(totals);
+#endif
+}
+
+} }
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { using namespace expected_v1; }
+#endif
+
+#endif // EELS_EXPECTED_INSTRUMENTATION_H_
@@ -0,0 +1,105 @@
+#ifndef EELS_EXPECTED_NICHE_H_
+#define EELS_EXPECTED_NICHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <eels/config.h>
+#include <eels/expected/detail/niche.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 {
+#else
+namespace eels { inline namespace expected_v1 {
+#endif
+
+// Customization point describing bit patterns a type never uses.
+// When 'has_niche' is true, 'expected' stores its valid/error state inside those bytes instead of a separate flag.
+// A specialization with a niche provides:
+//   offset, size    - the bytes [offset, offset + size) of the object representation holding the niche,
+//   set(object)     - writes the niche into raw storage where no T lives,
+//   test(object)    - tells whether raw storage holds the niche; must be false for every live T,
+//   slot_type       - (optional) type actually constructed in the storage, T or a class derived from it.
+// Types have no niche unless they are given one.
+template<typename T, typename EnableT = void>
+struct niche_traits
+{
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool has_niche = false;
+};
+
+// Opt-in niche in the tail padding of a class, when a derived class can reuse it:
+//   template<> struct niche_traits<my_class> : tail_padding_niche<my_class> { };
+// The state then lives in bytes the compiler never writes when copying or assigning a 'my_class',
+// but raw copies of the whole object do: the value of such an expected must never be overwritten
+// with 'std::memcpy' or with algorithms that may turn into one, such as 'std::copy'.
+template<typename T>
+struct tail_padding_niche
+	: detail::tail_padding_niche<T>
+{ };
+
+// Specialize to declare a value an enumeration never takes:
+//   template<> struct enum_sentinel<my_enum> : enum_sentinel_value<my_enum, my_enum::invalid> { };
+template<typename EnumT>
+struct enum_sentinel
+{
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool has_sentinel = false;
+};
+
+template<typename EnumT, EnumT SentinelV>
+struct enum_sentinel_value
+{
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool has_sentinel = true;
+	static EELS_CXX11_CONSTEXPR_OR_CONST EnumT value = SentinelV;
+};
+
+// Opt-in niche in the all-ones address, for pointers that never hold it:
+//   template<> struct niche_traits<my_class*> : pointer_niche<my_class*> { };
+// Pointers have no niche by default since handles such as 'MAP_FAILED' or 'INVALID_HANDLE_VALUE' use that address.
+template<typename PointerT>
+struct pointer_niche
+{
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool has_niche = true;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t offset = 0;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t size = sizeof(PointerT);
+
+	static_assert(std::is_pointer<PointerT>::value, "The pointer niche only applies to pointers.");
+	static_assert(sizeof(PointerT) == sizeof(std::uintptr_t), "Pointers are expected to be the size of 'std::uintptr_t'.");
+
+	static void set(void* object) EELS_NOEXCEPT_IF(true)
+	{ const std::uintptr_t bits = ~std::uintptr_t(0); std::memcpy(object, &bits, sizeof(bits)); }
+	static bool test(const void* object) EELS_NOEXCEPT_IF(true)
+	{ std::uintptr_t bits; std::memcpy(&bits, object, sizeof(bits)); return bits == ~std::uintptr_t(0); }
+};
+
+// bool: only 0 and 1 are valid object representations.
+template<>
+struct niche_traits<bool>
+{
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool has_niche = sizeof(bool) == 1;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t offset = 0;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t size = 1;
+
+	static void set(void* object) EELS_NOEXCEPT_IF(true)
+	{ *static_cast<unsigned char*>(object) = 0xFF; }
+	static bool test(const void* object) EELS_NOEXCEPT_IF(true)
+	{ return *static_cast<const unsigned char*>(object) > 1; }
+};
+
+// Enumerations with a declared sentinel.
+template<typename EnumT>
+struct niche_traits<EnumT, typename std::enable_if<std::is_enum<EnumT>::value && enum_sentinel<EnumT>::has_sentinel>::type>
+{
+	static EELS_CXX11_CONSTEXPR_OR_CONST bool has_niche = true;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t offset = 0;
+	static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t size = sizeof(EnumT);
+
+	static void set(void* object) EELS_NOEXCEPT_IF(true)
+	{ const EnumT sentinel = enum_sentinel<EnumT>::value; std::memcpy(object, &sentinel, sizeof(sentinel)); }
+	static bool test(const void* object) EELS_NOEXCEPT_IF(true)
+	{ EnumT value; std::memcpy(&value, object, sizeof(value)); return value == enum_sentinel<EnumT>::value; }
+};
+
+} }
+
+#endif // EELS_EXPECTED_NICHE_H_
@@ -0,0 +1,304 @@
+#ifndef EELS_EXPECTED_PARALLEL_H_
+#define EELS_EXPECTED_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <eels/config.h>
+#include <eels/expected/expected.h>
+#include <eels/expected/detail/call_result.h>
+#include <eels/expected/detail/thread_pool.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 {
+#else
+namespace eels { inline namespace expected_v1 {
+#endif
+
+// Which error a parallel algorithm returns when several elements fail.
+enum class error_policy
+{
+    lowest_index,   // the error of the failing element with the lowest index, as a sequential loop would return
+    any             // the first error found by any thread, other threads stop as soon as possible
+};
+
+class parallel_options
+{
+public:
+    parallel_options() : policy(error_policy::lowest_index), threads(0), chunk_size(0) { }
+
+    error_policy policy;
+    std::size_t threads;        // 0 uses every thread available
+    std::size_t chunk_size;     // 0 picks a size from the number of elements and threads
+};
+
+namespace detail {
+
+template<typename IteratorT, typename FunctionT>
+class parallel_result
+{
+public:
+    typedef typename std::decay<typename call_result<FunctionT&, typename std::iterator_traits<IteratorT>::reference>::type>::type expected_type;
+    typedef typename expected_type::value_type value_type;
+    typedef typename expected_type::error_type error_type;
+};
+
+// Elements are processed by chunks claimed in increasing order from a shared counter,
+// each thread claiming a new chunk as soon as it is done with the previous one.
+// The first failure cancels the elements that can no longer change the result:
+//  - lowest_index: the ones after it, those before it may still fail with a lower index,
+//  - any: all of them.
+// Exceptions thrown by the function are failures too, rethrown to the caller.
+template<typename IteratorT, typename FunctionT>
+class parallel_job
+{
+public:
+    typedef typename parallel_result<IteratorT, FunctionT>::expected_type expected_type;
+    typedef typename parallel_result<IteratorT, FunctionT>::error_type error_type;
+
+    parallel_job(IteratorT first, std::size_t size, FunctionT& function, const parallel_options& options)
+        : first_(first), size_(size), function_(&function), policy_(options.policy), next_chunk_(0), limit_(size), failure_index_(size)
+    {
+        const std::size_t participants = std::min(options.threads ? options.threads : max_participants(), max_participants());
+        chunk_size_ = options.chunk_size ? options.chunk_size : std::max<std::size_t>(size / (participants * 16), 1);
+        chunk_count_ = (size + chunk_size_ - 1) / chunk_size_;
+        participants_ = std::max<std::size_t>(std::min(participants, chunk_count_), 1);
+    }
+
+    std::size_t chunk_count() const { return chunk_count_; }
+
+    template<typename ChunkT>
+    void run(ChunkT process)
+    {
+        for(;;)
+        {
+            const std::size_t chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+            if(chunk >= chunk_count_)
+                return;
+            const std::size_t begin = chunk * chunk_size_;
+            if(begin >= limit_.load(std::memory_order_relaxed))
+                return;
+            process(chunk, begin, std::min(begin + chunk_size_, size_));
+        }
+    }
+
+    // Calls the function on an element and gives its value to 'sink', returns false when the element failed or is cancelled.
+    template<typename SinkT>
+    bool call(std::size_t index, SinkT sink)
+    {
+        if(index >= limit_.load(std::memory_order_relaxed))
+            return false;
+        try
+        {
+            expected_type result((*function_)(first_[static_cast<typename std::iterator_traits<IteratorT>::difference_type>(index)]));
+            if(result)
+            {
+                sink(std::move(*result));
+                return true;
+            }
+            fail(index, std::unique_ptr<error_type>(new error_type(std::move(result.error()))), std::exception_ptr());
+        }
+        catch(...)
+        {
+            fail(index, std::unique_ptr<error_type>(), std::current_exception());
+        }
+        return false;
+    }
+
+    // Fails from 'index' on with an exception thrown outside the function, such as while storing its values.
+    void fail(std::size_t index, std::exception_ptr exception)
+    {
+        fail(index, std::unique_ptr<error_type>(), exception);
+    }
+
+    std::size_t participants() const { return participants_; }
+    bool failed() const { return failure_index_ != size_; }
+
+    // Once every thread is done: rethrows the exception of the failure, if any, or returns its error.
+    error_type take_error()
+    {
+        if(exception_)
+            std::rethrow_exception(exception_);
+        return std::move(*error_);
+    }
+
+private:
+    void fail(std::size_t index, std::unique_ptr<error_type> error, std::exception_ptr exception)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(policy_ == error_policy::lowest_index ? index < failure_index_ : failure_index_ == size_)
+        {
+            failure_index_ = index;
+            error_ = std::move(error);
+            exception_ = exception;
+            limit_.store(policy_ == error_policy::lowest_index ? index : 0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    IteratorT first_;
+    std::size_t size_;
+    FunctionT* function_;
+    error_policy policy_;
+    std::size_t chunk_size_;
+    std::size_t chunk_count_;
+    std::size_t participants_;
+    std::atomic<std::size_t> next_chunk_;
+    std::atomic<std::size_t> limit_;    // elements from there on are cancelled
+
+    std::mutex mutex_;
+    std::size_t failure_index_;
+    std::unique_ptr<error_type> error_;
+    std::exception_ptr exception_;
+};
+
+class no_partial_t {};
+
+template<typename IteratorT, typename FunctionT>
+class collect_chunk
+{
+public:
+    typedef parallel_result<IteratorT, FunctionT> types;
+    typedef parallel_job<IteratorT, FunctionT> job_type;
+
+    collect_chunk(job_type& job, std::vector<std::vector<typename types::value_type> >& chunks) : job_(&job), chunks_(&chunks) { }
+
+    void operator()(std::size_t chunk, std::size_t begin, std::size_t end) const
+    {
+        std::vector<typename types::value_type>& values = (*chunks_)[chunk];
+        try
+        {
+            values.reserve(end - begin);
+        }
+        catch(...)
+        {
+            // chunks run on worker threads, where the exception must not escape
+            job_->fail(begin, std::current_exception());
+            return;
+        }
+        const auto sink = [&values](typename types::value_type&& val) { values.push_back(std::move(val)); };
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            if(!job_->call(i, sink))
+                break;
+        }
+    }
+
+private:
+    job_type* job_;
+    std::vector<std::vector<typename types::value_type> >* chunks_;
+};
+
+template<typename IteratorT, typename FunctionT, typename T, typename ReduceT>
+class reduce_chunk
+{
+public:
+    typedef parallel_result<IteratorT, FunctionT> types;
+    typedef parallel_job<IteratorT, FunctionT> job_type;
+    typedef expected<T, no_partial_t> partial_type;
+
+    reduce_chunk(job_type& job, ReduceT& reduce, std::vector<partial_type>& partials) : job_(&job), reduce_(&reduce), partials_(&partials) { }
+
+    void operator()(std::size_t chunk, std::size_t begin, std::size_t end) const
+    {
+        partial_type& partial = (*partials_)[chunk];
+        ReduceT& reduce = *reduce_;
+        const auto sink = [&partial, &reduce](typename types::value_type&& val) { partial = partial ? reduce(std::move(*partial), std::move(val)) : T(std::move(val)); };
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            if(!job_->call(i, sink))
+                break;
+        }
+    }
+
+private:
+    job_type* job_;
+    ReduceT* reduce_;
+    std::vector<partial_type>* partials_;
+};
+
+template<typename JobT, typename ChunkT>
+class parallel_runner
+{
+public:
+    parallel_runner(JobT& job, const ChunkT& chunk) : job_(&job), chunk_(chunk) { }
+    void operator()() { job_->run(chunk_); }
+
+private:
+    JobT* job_;
+    ChunkT chunk_;
+};
+
+template<typename JobT, typename ChunkT>
+void run_chunks(JobT& job, const ChunkT& chunk)
+{
+    parallel_runner<JobT, ChunkT> runner(job, chunk);
+    run_parallel(job.participants(), runner);
+}
+
+} // namespace detail
+
+// Calls 'function' on every element of [first, last), in parallel, and collects the values it returns in order.
+// 'function' returns an 'expected<V, E>', the result is either all the values or the error picked by 'options.policy';
+// once an element fails, the elements that can no longer change the result are not processed.
+template<typename IteratorT, typename FunctionT>
+expected<std::vector<typename detail::parallel_result<IteratorT, FunctionT>::value_type>, typename detail::parallel_result<IteratorT, FunctionT>::error_type>
+parallel_collect(IteratorT first, IteratorT last, FunctionT function, const parallel_options& options = parallel_options())
+{
+    static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<IteratorT>::iterator_category>::value, "'parallel_collect' requires random access iterators.");
+    typedef detail::parallel_result<IteratorT, FunctionT> types;
+    typedef expected<std::vector<typename types::value_type>, typename types::error_type> result_type;
+
+    detail::parallel_job<IteratorT, FunctionT> job(first, static_cast<std::size_t>(last - first), function, options);
+    std::vector<std::vector<typename types::value_type> > chunks(job.chunk_count());
+    detail::run_chunks(job, detail::collect_chunk<IteratorT, FunctionT>(job, chunks));
+    if(job.failed())
+        return result_type(unexpected, job.take_error());
+
+    std::vector<typename types::value_type> values;
+    values.reserve(static_cast<std::size_t>(last - first));
+    for(typename std::vector<std::vector<typename types::value_type> >::iterator it = chunks.begin(); it != chunks.end(); ++it)
+        values.insert(values.end(), std::make_move_iterator(it->begin()), std::make_move_iterator(it->end()));
+    return result_type(in_place, std::move(values));
+}
+
+// Calls 'transform' on every element of [first, last), in parallel, and combines the values it returns with 'reduce', starting from 'init'.
+// Values are combined in order, so the result only requires 'reduce' to be associative.
+// Errors are handled as in 'parallel_collect'.
+template<typename IteratorT, typename T, typename ReduceT, typename FunctionT>
+expected<T, typename detail::parallel_result<IteratorT, FunctionT>::error_type>
+parallel_transform_reduce(IteratorT first, IteratorT last, T init, ReduceT reduce, FunctionT transform, const parallel_options& options = parallel_options())
+{
+    static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<IteratorT>::iterator_category>::value, "'parallel_transform_reduce' requires random access iterators.");
+    typedef detail::parallel_result<IteratorT, FunctionT> types;
+    typedef expected<T, typename types::error_type> result_type;
+    typedef detail::reduce_chunk<IteratorT, FunctionT, T, ReduceT> chunk_type;
+
+    detail::parallel_job<IteratorT, FunctionT> job(first, static_cast<std::size_t>(last - first), transform, options);
+    std::vector<typename chunk_type::partial_type> partials(job.chunk_count());
+    detail::run_chunks(job, chunk_type(job, reduce, partials));
+    if(job.failed())
+        return result_type(unexpected, job.take_error());
+
+    for(typename std::vector<typename chunk_type::partial_type>::iterator it = partials.begin(); it != partials.end(); ++it)
+    {
+        if(*it)
+            init = reduce(std::move(init), std::move(**it));
+    }
+    return result_type(in_place, std::move(init));
+}
+
+} }
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { using namespace expected_v1; }
+#endif
+
+#endif // EELS_EXPECTED_PARALLEL_H_
@@ -0,0 +1,78 @@
+#ifndef EELS_EXPECTED_PIPELINE_H_
+#define EELS_EXPECTED_PIPELINE_H_
+
+#include <type_traits>
+#include <utility>
+#include <eels/config.h>
+#include <eels/expected/expected.h>
+#include <eels/expected/detail/pipeline.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 {
+#else
+namespace eels { inline namespace expected_v1 {
+#endif
+
+// Lazy form of the monadic operations of 'expected':
+//   expected<int, error> r = e | map(f) | and_then(g) | map_error(h);
+// The stages are fused into a single function run when the pipeline is converted to an expected (or by 'evaluate()'):
+// no intermediate expected is constructed, apart from the ones returned by the functions given to 'and_then' and 'or_else',
+// and an error skips every following value stage.
+// A pipeline references its source when it is an lvalue, it must then be evaluated before the source is destroyed.
+
+template<typename FunctionT>
+detail::stage<detail::map_t, typename std::decay<FunctionT>::type> map(FunctionT&& function)
+{
+    return detail::stage<detail::map_t, typename std::decay<FunctionT>::type>(std::forward<FunctionT>(function));
+}
+
+template<typename FunctionT>
+detail::stage<detail::and_then_t, typename std::decay<FunctionT>::type> and_then(FunctionT&& function)
+{
+    return detail::stage<detail::and_then_t, typename std::decay<FunctionT>::type>(std::forward<FunctionT>(function));
+}
+
+template<typename FunctionT>
+detail::stage<detail::or_else_t, typename std::decay<FunctionT>::type> or_else(FunctionT&& function)
+{
+    return detail::stage<detail::or_else_t, typename std::decay<FunctionT>::type>(std::forward<FunctionT>(function));
+}
+
+template<typename FunctionT>
+detail::stage<detail::map_error_t, typename std::decay<FunctionT>::type> map_error(FunctionT&& function)
+{
+    return detail::stage<detail::map_error_t, typename std::decay<FunctionT>::type>(std::forward<FunctionT>(function));
+}
+
+template<typename ValueT, typename ErrorT, typename KindT, typename FunctionT>
+detail::pipeline<detail::pipeline<expected<ValueT, ErrorT>&, void>, detail::stage<KindT, FunctionT> > operator|(expected<ValueT, ErrorT>& source, detail::stage<KindT, FunctionT> s)
+{
+    return detail::pipeline<detail::pipeline<expected<ValueT, ErrorT>&, void>, detail::stage<KindT, FunctionT> >(detail::pipeline<expected<ValueT, ErrorT>&, void>(source), std::move(s));
+}
+
+template<typename ValueT, typename ErrorT, typename KindT, typename FunctionT>
+detail::pipeline<detail::pipeline<const expected<ValueT, ErrorT>&, void>, detail::stage<KindT, FunctionT> > operator|(const expected<ValueT, ErrorT>& source, detail::stage<KindT, FunctionT> s)
+{
+    return detail::pipeline<detail::pipeline<const expected<ValueT, ErrorT>&, void>, detail::stage<KindT, FunctionT> >(detail::pipeline<const expected<ValueT, ErrorT>&, void>(source), std::move(s));
+}
+
+// the pipeline takes ownership of a temporary source
+template<typename ValueT, typename ErrorT, typename KindT, typename FunctionT>
+detail::pipeline<detail::pipeline<expected<ValueT, ErrorT>, void>, detail::stage<KindT, FunctionT> > operator|(expected<ValueT, ErrorT>&& source, detail::stage<KindT, FunctionT> s)
+{
+    return detail::pipeline<detail::pipeline<expected<ValueT, ErrorT>, void>, detail::stage<KindT, FunctionT> >(detail::pipeline<expected<ValueT, ErrorT>, void>(std::move(source)), std::move(s));
+}
+
+template<typename PreviousT, typename StageT, typename KindT, typename FunctionT>
+detail::pipeline<detail::pipeline<PreviousT, StageT>, detail::stage<KindT, FunctionT> > operator|(detail::pipeline<PreviousT, StageT>&& previous, detail::stage<KindT, FunctionT> s)
+{
+    return detail::pipeline<detail::pipeline<PreviousT, StageT>, detail::stage<KindT, FunctionT> >(std::move(previous), std::move(s));
+}
+
+} }
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { using namespace expected_v1; }
+#endif
+
+#endif // EELS_EXPECTED_PIPELINE_H_
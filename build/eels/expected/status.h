@@ -0,0 +1,157 @@
+#ifndef EELS_EXPECTED_STATUS_H_
+#define EELS_EXPECTED_STATUS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <eels/config.h>
+#include <eels/expected/niche.h>
+#include <eels/expected/detail/status_registry.h>
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { namespace expected_v1 {
+#else
+namespace eels { inline namespace expected_v1 {
+#endif
+
+// Family of status codes, such as the errors of a library or a protocol.
+// Messages are only formatted when a status is asked for one.
+class status_domain
+{
+public:
+    virtual ~status_domain() { }
+
+    virtual const char* name() const = 0;
+    virtual std::string message(int code) const = 0;
+};
+
+// Domain of the 'errno' values, code 0 standing for an unspecified error.
+static EELS_CXX11_CONSTEXPR_OR_CONST unsigned generic_status_domain = 0;
+
+// Registers a domain for the rest of the program and returns its identifier.
+// Throws 'std::length_error' once 'detail::status_registry::max_domains' domains exist.
+inline unsigned register_status_domain(const status_domain& domain)
+{
+    return detail::status_registry::instance().add(domain);
+}
+
+// Error made of a domain and a code, and optionally a text detailing it, in a single word:
+//  - domain and code packed in the word, the lowest bit set,
+//  - or a pointer to an interned record, when there is a text or the code does not fit.
+// Interned records are never freed, so copying a status copies a word and failing allocates nothing
+// once a text has been seen; texts are meant to come from a bounded set, not to be built for every error.
+// Domains are below 'detail::status_registry::max_domains', the constructors throw 'std::out_of_range' otherwise.
+class status
+{
+public:
+    // generic, unspecified error
+    EELS_CXX11_CONSTEXPR status() : bits_(packed_tag) { }
+
+    status(unsigned domain, int code)
+        : bits_(make(domain, code, nullptr, 0))
+    { }
+
+    // a null payload is no payload
+    status(unsigned domain, int code, const char* payload)
+        : bits_(make(domain, code, payload, payload ? std::strlen(payload) : 0))
+    { }
+
+    status(unsigned domain, int code, const std::string& payload)
+        : bits_(make(domain, code, payload.data(), payload.size()))
+    { }
+
+    unsigned domain() const { return packed() ? static_cast<unsigned>((bits_ >> domain_shift) & domain_mask) : record()->domain; }
+    int code() const { return packed() ? static_cast<int>(static_cast<std::intptr_t>(bits_) >> code_shift) : record()->code; }
+
+    // null when there is none
+    const char* payload() const { return packed() ? nullptr : record()->payload; }
+
+    const char* domain_name() const
+    {
+        const status_domain* const d = find_domain();
+        return d ? d->name() : domain() == generic_status_domain ? "generic" : "unregistered";
+    }
+
+    // The message of the code, followed by the payload.
+    std::string message() const
+    {
+        const status_domain* const d = find_domain();
+        std::string text = d ? d->message(code())
+                         : domain() == generic_status_domain ? (code() ? std::generic_category().message(code()) : std::string("unspecified error"))
+                         : std::string("unregistered status domain");
+        if(const char* const p = payload())
+            text.append(": ").append(p);
+        return text;
+    }
+
+    // Statuses with the same domain and code are equal, whatever their payloads.
+    friend bool operator==(const status& lhs, const status& rhs) { return lhs.bits_ == rhs.bits_ || (lhs.domain() == rhs.domain() && lhs.code() == rhs.code()); }
+    friend bool operator!=(const status& lhs, const status& rhs) { return !(lhs == rhs); }
+
+private:
+    static EELS_CXX11_CONSTEXPR_OR_CONST std::uintptr_t packed_tag = 1;
+    static EELS_CXX11_CONSTEXPR_OR_CONST unsigned domain_shift = 1;
+    static EELS_CXX11_CONSTEXPR_OR_CONST std::uintptr_t domain_mask = detail::status_registry::max_domains - 1;
+    // a whole 'int' on 64-bit platforms, what is left on 32-bit ones
+    static EELS_CXX11_CONSTEXPR_OR_CONST unsigned code_shift = sizeof(std::uintptr_t) >= 8 ? 32 : 9;
+    static EELS_CXX11_CONSTEXPR_OR_CONST unsigned code_bits = sizeof(std::uintptr_t) * 8 - code_shift;
+
+    static bool fits(int code)
+    {
+        return code_bits >= sizeof(int) * 8 || (code >= -(std::intptr_t(1) << (code_bits - 1)) && code < (std::intptr_t(1) << (code_bits - 1)));
+    }
+
+    static std::uintptr_t pack(unsigned domain, int code)
+    {
+        return (static_cast<std::uintptr_t>(static_cast<std::intptr_t>(code)) << code_shift) | (static_cast<std::uintptr_t>(domain) << domain_shift) | packed_tag;
+    }
+
+    static std::uintptr_t make(unsigned domain, int code, const char* payload, std::size_t size)
+    {
+        // out of range domains would alias others once packed
+        if(domain >= detail::status_registry::max_domains)
+            throw std::out_of_range("Unknown status domain.");
+        return !payload && fits(code) ? pack(domain, code) : reinterpret_cast<std::uintptr_t>(detail::status_registry::instance().intern(domain, code, payload, size));
+    }
+
+    bool packed() const { return (bits_ & packed_tag) != 0; }
+    const detail::status_record* record() const { return reinterpret_cast<const detail::status_record*>(bits_); }
+
+    const status_domain* find_domain() const { return detail::status_registry::instance().find(domain()); }
+
+private:
+    std::uintptr_t bits_;
+};
+
+// The two lowest bits of a status are never '10': packed statuses set the lowest one, and records are aligned.
+// An 'expected' can then store its state there, and a small value in the rest of the word.
+template<>
+struct niche_traits<status>
+{
+    static_assert(std::alignment_of<detail::status_record>::value >= 4, "Status records must leave the two lowest bits of their address clear.");
+
+    static EELS_CXX11_CONSTEXPR_OR_CONST bool has_niche = true;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t offset = sizeof(std::uintptr_t) - 1;
+#else
+    static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t offset = 0;
+#endif
+    static EELS_CXX11_CONSTEXPR_OR_CONST std::size_t size = 1;
+
+    static void set(void* object) EELS_NOEXCEPT_IF(true)
+    { static_cast<unsigned char*>(object)[offset] = 2; }
+    static bool test(const void* object) EELS_NOEXCEPT_IF(true)
+    { return (static_cast<const unsigned char*>(object)[offset] & 3) == 2; }
+};
+
+} }
+
+#if defined(EELS_NO_CXX11_INLINE_NAMESPACES)
+namespace eels { using namespace expected_v1; }
+#endif
+
+#endif // EELS_EXPECTED_STATUS_H_
@@ -0,0 +1,6 @@
+#ifndef EELS_EXPECTED_VECTOR_H_
+#define EELS_EXPECTED_VECTOR_H_
+
+#include <eels/expected/expected_vector.h>
+
+#endif // EELS_EXPECTED_VECTOR_H_
\ No newline at end of file
@@ -0,0 +1,6 @@
+#ifndef EELS_PARALLEL_H_
+#define EELS_PARALLEL_H_
+
+#include <eels/expected/parallel.h>
+
+#endif // EELS_PARALLEL_H_
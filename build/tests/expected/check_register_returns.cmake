@@ -0,0 +1,17 @@
+# Compiles register_returns.cpp to assembly and fails when one of its functions returns its result through memory.
+#   cmake -DCOMPILER=<c++> -DSTANDARD=<17|20> -DINCLUDE_DIR=<dir> -DSOURCE=<file> -DOUTPUT=<file> [-DDEFINITIONS=<list>] -P check_register_returns.cmake
+set(flags -std=c++${STANDARD} -O2 -S)
+foreach(definition ${DEFINITIONS})
+    list(APPEND flags -D${definition})
+endforeach()
+
+execute_process(COMMAND ${COMPILER} ${flags} -I${INCLUDE_DIR} ${SOURCE} -o ${OUTPUT}
+                RESULT_VARIABLE result ERROR_VARIABLE errors)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Compiling ${SOURCE} failed:\n${errors}")
+endif()
+
+file(READ ${OUTPUT} assembly)
+if(assembly MATCHES "\\(%rdi\\)")
+    message(FATAL_ERROR "An expected is returned through memory, see ${OUTPUT}.")
+endif()
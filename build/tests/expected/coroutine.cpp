@@ -0,0 +1,154 @@
+#include <eels/config.h>
+
+#if !defined(EELS_NO_CXX20_COROUTINES)
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include <eels/expected.h>
+
+namespace {
+
+typedef eels::expected<int, std::string> result;
+
+result parse_digit(char c)
+{
+    if(c < '0' || c > '9')
+        return eels::make_unexpected(std::string("not a digit: ") + c);
+    return c - '0';
+}
+
+int statements_after_await = 0;
+
+result add_digits(char a, char b)
+{
+    const int first = co_await parse_digit(a);
+    const int second = co_await parse_digit(b);
+    ++statements_after_await;
+    co_return first + second;
+}
+
+// counts the objects alive in coroutine frames
+struct guard
+{
+    static int alive;
+    guard() { ++alive; }
+    ~guard() { --alive; }
+};
+
+int guard::alive = 0;
+
+result guarded(const result& source)
+{
+    guard g;
+    co_return co_await source;
+}
+
+result nested(int depth)
+{
+    if(depth == 0)
+        co_return eels::make_unexpected(std::string("bottom"));
+    guard g;
+    co_return co_await nested(depth - 1) + 1;
+}
+
+eels::expected<long, std::string> widen(eels::expected<int, const char*> source)
+{
+    co_return co_await source;
+}
+
+}
+
+TEST(coroutine, returns_value)
+{
+    statements_after_await = 0;
+    const result sum = add_digits('4', '2');
+    ASSERT_TRUE(sum);
+    EXPECT_EQ(6, *sum);
+    EXPECT_EQ(1, statements_after_await);
+}
+
+TEST(coroutine, error_completes_the_coroutine)
+{
+    statements_after_await = 0;
+    const result first = add_digits('x', '2');
+    ASSERT_FALSE(first);
+    EXPECT_EQ("not a digit: x", first.error());
+
+    const result second = add_digits('4', 'y');
+    ASSERT_FALSE(second);
+    EXPECT_EQ("not a digit: y", second.error());
+    EXPECT_EQ(0, statements_after_await) << "Nothing after a failed 'co_await' should run.";
+}
+
+TEST(coroutine, co_return_factory)
+{
+    auto check = [](int v) -> result
+    {
+        if(v < 0)
+            co_return eels::make_unexpected(std::string("negative"));
+        co_return v;
+    };
+    EXPECT_EQ(3, *check(3));
+    EXPECT_EQ("negative", check(-3).error());
+}
+
+TEST(coroutine, converts_errors)
+{
+    EXPECT_EQ(7l, *widen(7));
+    const eels::expected<long, std::string> converted = widen(eels::expected<int, const char*>(eels::unexpected, "narrow"));
+    ASSERT_FALSE(converted);
+    EXPECT_EQ("narrow", converted.error()) << "The error should be converted to the error type of the coroutine.";
+}
+
+TEST(coroutine, await_forwards_the_source)
+{
+    auto take = [](eels::expected<std::unique_ptr<int>, int> source) -> eels::expected<int, int>
+    {
+        std::unique_ptr<int> p = co_await std::move(source);
+        co_return *p;
+    };
+    EXPECT_EQ(5, *take(std::unique_ptr<int>(new int(5)))) << "An rvalue should give its value by move.";
+
+    auto increment = [](eels::expected<int, int>& source) -> eels::expected<int, int>
+    {
+        int& value = co_await source;
+        co_return ++value;
+    };
+    eels::expected<int, int> counter(1);
+    increment(counter);
+    EXPECT_EQ(2, *counter) << "An lvalue should give a reference to its value.";
+}
+
+TEST(coroutine, destroys_frames)
+{
+    guard::alive = 0;
+    EXPECT_EQ(3, *guarded(3));
+    EXPECT_EQ("failure", guarded(result(eels::unexpected, "failure")).error());
+    EXPECT_EQ(0, guard::alive) << "The frame should be destroyed whether the coroutine returns or fails.";
+
+    const result deep = nested(64);
+    ASSERT_FALSE(deep);
+    EXPECT_EQ("bottom", deep.error()) << "Errors should go through every level.";
+    EXPECT_EQ(0, guard::alive);
+}
+
+TEST(coroutine, exceptions)
+{
+    auto throwing = [](const result& source) -> result
+    {
+        guard g;
+        const int value = co_await source;
+        if(value == 0)
+            throw std::invalid_argument("zero");
+        co_return value;
+    };
+
+    guard::alive = 0;
+    EXPECT_THROW(throwing(0), std::invalid_argument);
+    EXPECT_EQ(0, guard::alive) << "The frame should be destroyed when an exception leaves the coroutine.";
+    EXPECT_EQ(1, *throwing(1)) << "Frames should still be allocated once an exception left a coroutine.";
+}
+
+#endif // !defined(EELS_NO_CXX20_COROUTINES)
@@ -0,0 +1,131 @@
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <gtest/gtest.h>
+#include <eels/expected.h>
+
+namespace {
+
+bool fail_next_copy = false;
+bool fail_next_move = false;
+
+struct injected_failure
+    : std::runtime_error
+{
+    injected_failure() : std::runtime_error("injected failure") { }
+};
+
+void check_failure(bool& flag)
+{
+    if(flag)
+    {
+        flag = false;
+        throw injected_failure();
+    }
+}
+
+// copy may throw, move never does
+struct throwing_copy
+{
+    explicit throwing_copy(int v) : value(v) { }
+    throwing_copy(const throwing_copy& other) : value(other.value) { check_failure(fail_next_copy); }
+    throwing_copy(throwing_copy&& other) EELS_NOEXCEPT_IF(true) : value(other.value) { }
+    throwing_copy& operator=(const throwing_copy& other) { check_failure(fail_next_copy); value = other.value; return *this; }
+    throwing_copy& operator=(throwing_copy&& other) EELS_NOEXCEPT_IF(true) { value = other.value; return *this; }
+    int value;
+};
+
+// both copy and move may throw
+struct throwing_move
+{
+    explicit throwing_move(int v) : value(v) { }
+    throwing_move(const throwing_move& other) : value(other.value) { check_failure(fail_next_copy); }
+    throwing_move(throwing_move&& other) : value(other.value) { check_failure(fail_next_move); }
+    throwing_move& operator=(const throwing_move& other) { check_failure(fail_next_copy); value = other.value; return *this; }
+    throwing_move& operator=(throwing_move&& other) { check_failure(fail_next_move); value = other.value; return *this; }
+    int value;
+};
+
+}
+
+static_assert(sizeof(eels::expected<std::string, std::string>) < 2 * sizeof(std::string), "Alternatives with a nothrow move constructor should share the same bytes.");
+static_assert(sizeof(eels::expected<std::vector<int>, std::string>) < sizeof(std::vector<int>) + sizeof(std::string), "Alternatives with a nothrow move constructor should share the same bytes.");
+static_assert(sizeof(eels::expected<throwing_move, int>) == sizeof(eels::expected<int, int>), "A single alternative with a nothrow move constructor is enough to share the same bytes.");
+static_assert(sizeof(eels::expected<throwing_move, throwing_move>) >= 2 * sizeof(throwing_move), "Alternatives without nothrow move constructor cannot share the same bytes.");
+
+TEST(exception_safety, nothrow_switch)
+{
+    eels::expected<throwing_copy, throwing_copy> e(throwing_copy(1));
+    e = eels::expected<throwing_copy, throwing_copy>(eels::unexpected, throwing_copy(2));
+    ASSERT_FALSE(e) << "Moving in an error should switch to the error state.";
+    EXPECT_EQ(2, e.error().value);
+
+    e = throwing_copy(3);
+    ASSERT_TRUE(e) << "Moving in a value should switch to the valid state.";
+    EXPECT_EQ(3, e->value);
+}
+
+TEST(exception_safety, target_aside_switch_to_error)
+{
+    eels::expected<throwing_copy, throwing_copy> e(throwing_copy(1));
+    const eels::expected<throwing_copy, throwing_copy> error(eels::unexpected, throwing_copy(2));
+
+    fail_next_copy = true;
+    EXPECT_THROW(e = error, injected_failure);
+    ASSERT_TRUE(e) << "A throwing copy of the error should leave the value untouched.";
+    EXPECT_EQ(1, e->value);
+
+    e = error;
+    ASSERT_FALSE(e) << "A successful copy of the error should switch to the error state.";
+    EXPECT_EQ(2, e.error().value);
+}
+
+TEST(exception_safety, target_aside_switch_to_value)
+{
+    eels::expected<throwing_copy, std::string> e(eels::unexpected, "error");
+    const throwing_copy value(2);
+
+    fail_next_copy = true;
+    EXPECT_THROW(e = value, injected_failure);
+    ASSERT_FALSE(e) << "A throwing copy of the value should leave the error untouched.";
+    EXPECT_EQ("error", e.error());
+
+    e = value;
+    ASSERT_TRUE(e) << "A successful copy of the value should switch to the valid state.";
+    EXPECT_EQ(2, e->value);
+}
+
+TEST(exception_safety, source_aside_switch)
+{
+    eels::expected<throwing_move, int> e(eels::unexpected, 1);
+    const throwing_move value(2);
+
+    fail_next_copy = true;
+    EXPECT_THROW(e = value, injected_failure);
+    ASSERT_FALSE(e) << "A throwing copy of the value should restore the error.";
+    EXPECT_EQ(1, e.error());
+
+    e = value;
+    ASSERT_TRUE(e) << "A successful copy of the value should switch to the valid state.";
+    EXPECT_EQ(2, e->value);
+
+    e = eels::expected<throwing_move, int>(eels::unexpected, 3);
+    ASSERT_FALSE(e) << "Switching to a nothrow error should always succeed.";
+    EXPECT_EQ(3, e.error());
+}
+
+TEST(exception_safety, independent_switch)
+{
+    eels::expected<throwing_move, throwing_move> e(throwing_move(1));
+    const eels::expected<throwing_move, throwing_move> error(eels::unexpected, throwing_move(2));
+
+    fail_next_copy = true;
+    EXPECT_THROW(e = error, injected_failure);
+    ASSERT_TRUE(e) << "A throwing copy of the error should leave the value untouched.";
+    EXPECT_EQ(1, e->value);
+
+    e = error;
+    ASSERT_FALSE(e) << "A successful copy of the error should switch to the error state.";
+    EXPECT_EQ(2, e.error().value);
+}
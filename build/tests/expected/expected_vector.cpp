@@ -0,0 +1,132 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <eels/expected.h>
+#include <eels/expected_vector.h>
+
+namespace {
+
+typedef eels::expected_vector<int, std::string> vector_type;
+
+// every 'period'-th element, starting at 'offset', is an error
+vector_type make_vector(std::size_t size, std::size_t period, std::size_t offset)
+{
+    vector_type v;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        if(period && i % period == offset)
+            v.push_back(eels::make_unexpected("error " + std::to_string(i)));
+        else
+            v.push_back(eels::make_expected(static_cast<int>(i)));
+    }
+    return v;
+}
+
+}
+
+TEST(expected_vector, push_back)
+{
+    vector_type v;
+    v.push_back(eels::expected<int, std::string>(1));
+    v.push_back(eels::expected<int, std::string>(eels::unexpected, "two"));
+    const eels::expected<int, std::string> three(3);
+    v.push_back(three);
+    v.push_back(eels::make_expected(4));
+    v.push_back(eels::make_unexpected(3, 'x'));
+
+    ASSERT_EQ(5u, v.size());
+    EXPECT_EQ(1, *v[0]);
+    EXPECT_FALSE(v[1]);
+    EXPECT_EQ("two", v[1].error());
+    EXPECT_EQ(3, *v[2]);
+    EXPECT_EQ(4, *v[3]);
+    EXPECT_EQ("xxx", v[4].error()) << "make_unexpected arguments should construct the error in place.";
+}
+
+TEST(expected_vector, emplace_back)
+{
+    eels::expected_vector<std::string, std::string> v;
+    EXPECT_EQ("aaa", *v.emplace_back(eels::in_place, 3, 'a'));
+    EXPECT_EQ("bb", v.emplace_back(eels::unexpected, 2, 'b').error());
+    EXPECT_EQ("c", *v.emplace_back(eels::make_expected("c")));
+    EXPECT_EQ("d", v.emplace_back(eels::make_unexpected("d")).error());
+    EXPECT_EQ(4u, v.size());
+}
+
+TEST(expected_vector, element_access)
+{
+    vector_type v = make_vector(200, 3, 1);
+    for(std::size_t i = 0; i < v.size(); ++i)
+    {
+        if(i % 3 == 1)
+        {
+            ASSERT_FALSE(v[i]) << "Element " << i << " should be an error.";
+            EXPECT_EQ("error " + std::to_string(i), v[i].error());
+        }
+        else
+        {
+            ASSERT_TRUE(v[i]) << "Element " << i << " should be valid.";
+            EXPECT_EQ(static_cast<int>(i), *v[i]);
+        }
+    }
+
+    *v[0] = 42;
+    EXPECT_EQ(42, *v[0]) << "The proxy should give access to the stored value.";
+    EXPECT_EQ(-1, v[1].value_or(-1));
+
+    const vector_type& c = v;
+    eels::expected<int, std::string> copy = c[2];
+    ASSERT_TRUE(copy) << "The proxy should convert to an expected.";
+    EXPECT_EQ(2, *copy);
+}
+
+TEST(expected_vector, count_errors)
+{
+    const vector_type v = make_vector(1000, 7, 3);
+    EXPECT_EQ(143u, v.count_errors());
+    for(std::size_t first = 0; first < 300; first += 37)
+    {
+        for(std::size_t last = first; last < v.size(); last += 61)
+        {
+            std::size_t expected_count = 0;
+            for(std::size_t i = first; i < last; ++i)
+                expected_count += i % 7 == 3;
+            EXPECT_EQ(expected_count, v.count_errors(first, last)) << "Range [" << first << ", " << last << ").";
+        }
+    }
+}
+
+TEST(expected_vector, first_error)
+{
+    const vector_type none = make_vector(1000, 0, 0);
+    EXPECT_EQ(none.size(), none.first_error()) << "No error should give the size.";
+    EXPECT_TRUE(none.all_valid());
+
+    const vector_type last = make_vector(1000, 1000, 999);
+    EXPECT_EQ(999u, last.first_error());
+    EXPECT_FALSE(last.all_valid());
+    EXPECT_TRUE(last.all_valid(0, 999));
+    EXPECT_FALSE(last.all_valid(500, 1000));
+
+    const vector_type sparse = make_vector(1000, 300, 150);
+    std::vector<std::size_t> errors;
+    for(std::size_t i = sparse.first_error(); i != sparse.size(); i = sparse.first_error(i + 1))
+        errors.push_back(i);
+    ASSERT_EQ(3u, errors.size()) << "Scanning from each error should find every error.";
+    EXPECT_EQ(150u, errors[0]);
+    EXPECT_EQ(450u, errors[1]);
+    EXPECT_EQ(750u, errors[2]);
+}
+
+TEST(expected_vector, partition)
+{
+    const vector_type v = make_vector(10, 4, 0);
+    const vector_type::partition_type p = v.partition();
+    ASSERT_EQ(7u, p.values.size());
+    ASSERT_EQ(3u, p.errors.size());
+    EXPECT_EQ(1, p.values[0]) << "Values should keep their order.";
+    EXPECT_EQ(9, p.values[6]);
+    EXPECT_EQ("error 0", p.errors[0]) << "Errors should keep their order.";
+    EXPECT_EQ("error 8", p.errors[2]);
+}
@@ -0,0 +1,86 @@
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <gtest/gtest.h>
+#include <eels/expected.h>
+
+#if defined(EELS_EXPECTED_INSTRUMENT)
+
+namespace {
+
+// switches from a value to an error 'count' times, and back
+void count_switches(int count)
+{
+    eels::expected<int, int> e(0);
+    for(int i = 0; i < count; ++i)
+    {
+        e = eels::make_unexpected(i);
+        e = i;
+    }
+}
+
+}
+
+TEST(instrumentation, snapshot_sums_every_thread)
+{
+    const eels::expected_counters before = eels::expected_counters_snapshot();
+    count_switches(1);
+    std::thread first(count_switches, 10);
+    std::thread second(count_switches, 100);
+    first.join();
+    second.join();
+    const eels::expected_counters counted = eels::expected_counters_snapshot() - before;
+
+    EXPECT_EQ(111u, counted.value_to_error_switches) << "Threads that exited should still be counted.";
+    EXPECT_EQ(111u, counted.error_to_value_switches);
+}
+
+TEST(instrumentation, thread_counters_are_per_thread)
+{
+    const eels::expected_counters before = eels::thread_expected_counters();
+    std::thread other(count_switches, 10);
+    other.join();
+    count_switches(1);
+
+    EXPECT_EQ(1u, (eels::thread_expected_counters() - before).value_to_error_switches) << "Only the calling thread should be counted.";
+}
+
+TEST(instrumentation, counts_operations)
+{
+    const eels::expected_counters before = eels::thread_expected_counters();
+    eels::expected<int, int> e(1);
+    eels::expected<int, int> copy(e);
+    eels::expected<int, int> moved(std::move(e));
+    e = eels::make_unexpected(2);
+    e = 3;
+    copy = moved;
+    const eels::expected_counters counted = eels::thread_expected_counters() - before;
+
+    EXPECT_EQ(1u, counted.value_to_error_switches);
+    EXPECT_EQ(1u, counted.error_to_value_switches);
+    EXPECT_EQ(3u, counted.constructions);
+    EXPECT_EQ(0u, counted.error_constructions);
+    EXPECT_EQ(2u, counted.copies);
+    EXPECT_EQ(1u, counted.moves);
+}
+
+#else
+
+TEST(instrumentation, costs_nothing_when_disabled)
+{
+    static_assert(std::is_trivially_copyable<eels::expected<int, int> >::value, "Trivial storage should be kept without instrumentation.");
+
+    const eels::expected_counters before = eels::expected_counters_snapshot();
+    eels::expected<int, int> e(1);
+    eels::expected<int, int> copy(e);
+    e = eels::make_unexpected(2);
+    copy = e;
+    const eels::expected_counters counted = eels::expected_counters_snapshot() - before;
+
+    EXPECT_EQ(0u, counted.constructions);
+    EXPECT_EQ(0u, counted.value_to_error_switches);
+    EXPECT_EQ(0u, counted.copies);
+    EXPECT_EQ(0u, eels::thread_expected_counters().constructions) << "Nothing should be counted without instrumentation.";
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include <eels/expected.h>
+
+namespace {
+
+enum class parse_error { empty, not_a_number, out_of_range };
+
+eels::expected<int, parse_error> parse(const std::string& text)
+{
+    if(text.empty())
+        return eels::make_unexpected(parse_error::empty);
+    int result = 0;
+    for(char c : text)
+    {
+        if(c < '0' || c > '9')
+            return eels::make_unexpected(parse_error::not_a_number);
+        result = result * 10 + (c - '0');
+    }
+    return result;
+}
+
+eels::expected<int, parse_error> check_percentage(int value)
+{
+    if(value > 100)
+        return eels::make_unexpected(parse_error::out_of_range);
+    return value;
+}
+
+// counts how many expected objects are alive or were ever constructed through its value
+struct tracked
+{
+    static int constructions;
+    explicit tracked(int v) : value(v) { ++constructions; }
+    tracked(const tracked& other) : value(other.value) { ++constructions; }
+    tracked(tracked&& other) : value(other.value) { ++constructions; }
+    int value;
+};
+
+int tracked::constructions = 0;
+
+}
+
+TEST(monadic, map)
+{
+    const eels::expected<int, parse_error> valid(21);
+    const eels::expected<int, parse_error> invalid(eels::unexpected, parse_error::empty);
+
+    eels::expected<std::string, parse_error> mapped = valid.map([](int v) { return std::to_string(v * 2); });
+    ASSERT_TRUE(mapped) << "Mapping a valid expected should give a valid expected.";
+    EXPECT_EQ("42", *mapped);
+
+    mapped = invalid.map([](int v) { return std::to_string(v * 2); });
+    ASSERT_FALSE(mapped) << "Mapping an invalid expected should keep the error.";
+    EXPECT_EQ(parse_error::empty, mapped.error());
+}
+
+TEST(monadic, and_then)
+{
+    EXPECT_EQ(42, *parse("42").and_then(check_percentage));
+    EXPECT_EQ(parse_error::out_of_range, parse("420").and_then(check_percentage).error()) << "The error of the function should be returned.";
+    EXPECT_EQ(parse_error::not_a_number, parse("4x").and_then(check_percentage).error()) << "The function should not be called on an error.";
+}
+
+TEST(monadic, or_else)
+{
+    auto fallback = [](parse_error err) { return err == parse_error::empty ? eels::expected<int, std::string>(0) : eels::expected<int, std::string>(eels::unexpected, "unrecoverable"); };
+
+    EXPECT_EQ(12, *parse("12").or_else(fallback)) << "The function should not be called on a value.";
+    EXPECT_EQ(0, *parse("").or_else(fallback)) << "The function should be able to recover from an error.";
+    EXPECT_EQ("unrecoverable", parse("1a").or_else(fallback).error()) << "The function should be able to replace the error.";
+}
+
+TEST(monadic, map_error)
+{
+    auto describe = [](parse_error err) { return err == parse_error::empty ? std::string("empty") : std::string("invalid"); };
+
+    EXPECT_EQ(12, *parse("12").map_error(describe));
+    EXPECT_EQ("empty", parse("").map_error(describe).error());
+}
+
+TEST(monadic, value_or)
+{
+    EXPECT_EQ(12, parse("12").value_or(-1));
+    EXPECT_EQ(-1, parse("?").value_or(-1));
+
+    const eels::expected<std::string, int> text(eels::unexpected, 1);
+    EXPECT_EQ("default", text.value_or("default")) << "The default should be converted to the value type.";
+}
+
+TEST(monadic, moves_from_rvalues)
+{
+    eels::expected<std::unique_ptr<int>, int> e(std::unique_ptr<int>(new int(3)));
+    eels::expected<int, int> r = std::move(e).map([](std::unique_ptr<int> p) { return *p; });
+    ASSERT_TRUE(r) << "The value of an rvalue expected should be moved into the function.";
+    EXPECT_EQ(3, *r);
+}
+
+TEST(monadic, pipeline)
+{
+    auto twice = [](int v) { return v * 2; };
+    auto describe = [](parse_error err) { return static_cast<int>(err); };
+
+    eels::expected<int, int> valid = parse("21") | eels::and_then(check_percentage) | eels::map(twice) | eels::map_error(describe);
+    ASSERT_TRUE(valid);
+    EXPECT_EQ(42, *valid);
+
+    eels::expected<int, int> invalid = parse("210") | eels::and_then(check_percentage) | eels::map(twice) | eels::map_error(describe);
+    ASSERT_FALSE(invalid) << "An error should skip the following value stages.";
+    EXPECT_EQ(static_cast<int>(parse_error::out_of_range), invalid.error()) << "An error should still go through the following error stages.";
+
+    const eels::expected<int, parse_error> source(eels::unexpected, parse_error::empty);
+    auto recovered = (source | eels::or_else([](parse_error) { return eels::expected<int, parse_error>(0); }) | eels::map(twice)).evaluate();
+    ASSERT_TRUE(recovered) << "A recovered error should go through the following value stages.";
+    EXPECT_EQ(0, *recovered);
+}
+
+TEST(monadic, pipeline_constructs_only_the_final_expected)
+{
+    auto add = [](tracked t) { return tracked(t.value + 1); };
+    eels::expected<tracked, int> source(eels::in_place, 0);
+
+    tracked::constructions = 0;
+    eels::expected<tracked, int> fused = source | eels::map(add) | eels::map(add) | eels::map(add);
+    const int fused_constructions = tracked::constructions;
+
+    tracked::constructions = 0;
+    eels::expected<tracked, int> eager = source.map(add).map(add).map(add);
+    const int eager_constructions = tracked::constructions;
+
+    EXPECT_EQ(3, fused->value);
+    EXPECT_EQ(3, eager->value);
+    EXPECT_LT(fused_constructions, eager_constructions) << "The fused pipeline should not construct intermediate expected objects.";
+}
@@ -0,0 +1,150 @@
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <gtest/gtest.h>
+#include <eels/expected.h>
+
+namespace {
+
+struct empty_error
+{ };
+
+enum class colour { red, green, blue, invalid };
+enum class status { ok, failed };
+
+class padded
+{
+public:
+    padded(std::int64_t number = 0, char letter = 0) : number_(number), letter_(letter) { }
+    std::int64_t number() const { return number_; }
+    char letter() const { return letter_; }
+private:
+    std::int64_t number_;
+    char letter_;
+};
+
+// Same layout as 'padded', without opting in to the tail padding niche.
+class unmarked
+{
+public:
+    unmarked(std::int64_t number = 0, char letter = 0) : number_(number), letter_(letter) { }
+    std::int64_t number() const { return number_; }
+private:
+    std::int64_t number_;
+    char letter_;
+};
+
+}
+
+namespace eels {
+template<> struct enum_sentinel<colour> : enum_sentinel_value<colour, colour::invalid> { };
+template<> struct niche_traits<padded> : tail_padding_niche<padded> { };
+template<> struct niche_traits<int*> : pointer_niche<int*> { };
+template<> struct niche_traits<const void*> : pointer_niche<const void*> { };
+}
+
+static_assert(eels::niche_traits<int*>::has_niche, "Pointers opting in should have a niche.");
+static_assert(!eels::niche_traits<char*>::has_niche, "Pointers should only have a niche when they opt in.");
+static_assert(eels::niche_traits<bool>::has_niche, "bool should have a niche.");
+static_assert(eels::niche_traits<colour>::has_niche, "Enumerations with a sentinel should have a niche.");
+static_assert(!eels::niche_traits<status>::has_niche, "Enumerations without sentinel should not have a niche.");
+static_assert(!eels::niche_traits<int>::has_niche, "Integers use all their bit patterns and should not have a niche.");
+static_assert(!eels::niche_traits<empty_error>::has_niche, "Empty classes have no tail padding and should not have a niche.");
+static_assert(!eels::niche_traits<unmarked>::has_niche, "Tail padding should only hold a niche when a type opts in.");
+
+static_assert(sizeof(eels::expected<int*, empty_error>) == sizeof(int*), "A pointer holds the state of an expected with an empty error type.");
+static_assert(sizeof(eels::expected<const void*, empty_error>) == sizeof(void*), "A pointer holds the state of an expected with an empty error type.");
+static_assert(sizeof(eels::expected<bool, empty_error>) == sizeof(bool), "A bool holds the state of an expected with an empty error type.");
+static_assert(sizeof(eels::expected<colour, empty_error>) == sizeof(colour), "An enumeration with a sentinel holds the state of an expected with an empty error type.");
+static_assert(sizeof(eels::expected<empty_error, colour>) == sizeof(colour), "An enumeration with a sentinel holds the state of an expected with an empty value type.");
+static_assert(sizeof(eels::expected<status, empty_error>) > sizeof(status), "An enumeration without sentinel has no niche.");
+static_assert(!eels::niche_traits<padded>::has_niche || sizeof(eels::expected<padded, int>) == sizeof(padded), "The tail padding of the value type holds the state when the ABI allows it.");
+static_assert(!eels::niche_traits<padded>::has_niche || sizeof(eels::expected<int, padded>) == sizeof(padded), "The tail padding of the error type holds the state when the ABI allows it.");
+
+TEST(niche, raw_copies_keep_the_state_by_default)
+{
+    const unmarked source(7, 'y');
+    eels::expected<unmarked, int> e(unmarked(1, 'a'));
+    std::memcpy(&*e, &source, sizeof(source));
+    EXPECT_TRUE(e) << "Copying the bytes of a value into it should not change the state.";
+    EXPECT_EQ(7, e->number());
+}
+
+TEST(niche, pointer_keeps_null_as_a_value)
+{
+    int i = 0;
+    eels::expected<int*, empty_error> e(nullptr);
+    EXPECT_TRUE(e) << "A null pointer should be a valid value.";
+    EXPECT_EQ(nullptr, *e);
+
+    e = eels::expected<int*, empty_error>(eels::unexpected);
+    EXPECT_FALSE(e) << "Assigning an error should switch to the error state.";
+
+    e = &i;
+    EXPECT_TRUE(e) << "Assigning a value should switch to the valid state.";
+    EXPECT_EQ(&i, *e);
+}
+
+TEST(niche, pointer_keeps_all_ones_as_a_value_by_default)
+{
+    char* const all_ones = reinterpret_cast<char*>(~std::uintptr_t(0));
+    eels::expected<char*, empty_error> e(all_ones);
+    EXPECT_TRUE(e) << "Addresses used as handles, such as 'MAP_FAILED', should be valid values.";
+    EXPECT_EQ(all_ones, *e);
+}
+
+TEST(niche, bool_keeps_both_values)
+{
+    eels::expected<bool, empty_error> f(false);
+    eels::expected<bool, empty_error> t(true);
+    eels::expected<bool, empty_error> u(eels::unexpected);
+    EXPECT_TRUE(f);
+    EXPECT_FALSE(*f);
+    EXPECT_TRUE(t);
+    EXPECT_TRUE(*t);
+    EXPECT_FALSE(u);
+
+    u = f;
+    EXPECT_TRUE(u) << "Copying a value should switch to the valid state.";
+    EXPECT_FALSE(*u);
+}
+
+TEST(niche, enumeration_with_sentinel)
+{
+    eels::expected<empty_error, colour> e(eels::unexpected, colour::red);
+    EXPECT_FALSE(e);
+    EXPECT_EQ(colour::red, e.error());
+
+    e = eels::expected<empty_error, colour>(empty_error());
+    EXPECT_TRUE(e) << "Assigning a value should switch to the valid state.";
+
+    e = eels::expected<empty_error, colour>(eels::unexpected, colour::blue);
+    EXPECT_FALSE(e) << "Assigning an error should switch to the error state.";
+    EXPECT_EQ(colour::blue, e.error());
+}
+
+TEST(niche, tail_padding)
+{
+    eels::expected<padded, int> e(padded(42, 'x'));
+    EXPECT_TRUE(e);
+    EXPECT_EQ(42, e->number());
+    EXPECT_EQ('x', e->letter());
+
+    e = padded(-1, '\xFF');
+    EXPECT_TRUE(e) << "Assigning a value should not touch the state stored in the tail padding.";
+    EXPECT_EQ(-1, e->number());
+
+    e = eels::expected<padded, int>(eels::unexpected, 7);
+    EXPECT_FALSE(e);
+    EXPECT_EQ(7, e.error());
+
+    eels::expected<padded, int> copy(e);
+    EXPECT_FALSE(copy) << "Copying should preserve the error state.";
+    EXPECT_EQ(7, copy.error());
+
+    e = padded(1, 'a');
+    copy = e;
+    EXPECT_TRUE(copy) << "Copying should preserve the valid state.";
+    EXPECT_EQ(1, copy->number());
+    EXPECT_EQ('a', copy->letter());
+}
@@ -0,0 +1,387 @@
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <eels/expected.h>
+
+namespace {
+
+std::size_t allocations = 0;
+
+// Payloads are allocated through here to be counted, rather than by replacing the global allocation functions,
+// which would then need every one of their overloads.
+int* allocate_payload(int value)
+{
+    ++allocations;
+    return new int(value);
+}
+
+struct counters
+{
+    int constructions;
+    int copies;
+    int moves;
+    int copy_assignments;
+    int move_assignments;
+    int destructions;
+};
+
+bool operator==(const counters& lhs, const counters& rhs)
+{
+    return lhs.constructions == rhs.constructions && lhs.copies == rhs.copies && lhs.moves == rhs.moves &&
+           lhs.copy_assignments == rhs.copy_assignments && lhs.move_assignments == rhs.move_assignments && lhs.destructions == rhs.destructions;
+}
+
+std::ostream& operator<<(std::ostream& os, const counters& c)
+{
+    return os << "{ constructions: " << c.constructions << ", copies: " << c.copies << ", moves: " << c.moves
+              << ", copy_assignments: " << c.copy_assignments << ", move_assignments: " << c.move_assignments << ", destructions: " << c.destructions << " }";
+}
+
+// Owns a heap allocated payload, like most real payloads do: copies may throw, moves cannot.
+template<int Id>
+class counted
+{
+public:
+    static counters counts;
+
+    counted() EELS_NOEXCEPT_IF(true) : payload_(nullptr) { ++counts.constructions; }
+    counted(int value, int factor) : payload_(allocate_payload(value * factor)) { ++counts.constructions; }
+    explicit counted(int value) : payload_(allocate_payload(value)) { ++counts.constructions; }
+    counted(const counted<Id>& other) : payload_(other.payload_ ? allocate_payload(*other.payload_) : nullptr) { ++counts.copies; }
+    counted(counted<Id>&& other) EELS_NOEXCEPT_IF(true) : payload_(other.payload_) { other.payload_ = nullptr; ++counts.moves; }
+    ~counted() { delete payload_; ++counts.destructions; }
+
+    counted<Id>& operator=(const counted<Id>& other)
+    {
+        int* payload = other.payload_ ? allocate_payload(*other.payload_) : nullptr;
+        delete payload_;
+        payload_ = payload;
+        ++counts.copy_assignments;
+        return *this;
+    }
+
+    counted<Id>& operator=(counted<Id>&& other) EELS_NOEXCEPT_IF(true)
+    {
+        std::swap(payload_, other.payload_);
+        ++counts.move_assignments;
+        return *this;
+    }
+
+    int get() const { return payload_ ? *payload_ : 0; }
+
+private:
+    int* payload_;
+};
+
+template<int Id>
+counters counted<Id>::counts;
+
+typedef counted<0> value;
+typedef counted<1> error;
+typedef eels::expected<value, error> expected;
+
+counters make_counters(int constructions, int copies, int moves, int copy_assignments, int move_assignments, int destructions)
+{
+    counters c = { constructions, copies, moves, copy_assignments, move_assignments, destructions };
+    return c;
+}
+
+const counters none = { 0, 0, 0, 0, 0, 0 };
+
+// Records the operations done on both types, and the allocations, by a single expression.
+class operation_count
+    : public ::testing::Test
+{
+protected:
+    void start()
+    {
+        value::counts = none;
+        error::counts = none;
+        allocations_ = allocations;
+    }
+
+    void stop()
+    {
+        values = value::counts;
+        errors = error::counts;
+        allocated = allocations - allocations_;
+    }
+
+    counters values;
+    counters errors;
+    std::size_t allocated;
+
+private:
+    std::size_t allocations_;
+};
+
+}
+
+TEST_F(operation_count, default_constructor)
+{
+    start();
+    expected e;
+    stop();
+    EXPECT_EQ(none, values);
+    EXPECT_EQ(make_counters(1, 0, 0, 0, 0, 0), errors);
+    EXPECT_EQ(0u, allocated);
+}
+
+TEST_F(operation_count, copy_constructor)
+{
+    const expected other(value(1));
+    start();
+    expected e(other);
+    stop();
+    EXPECT_EQ(make_counters(0, 1, 0, 0, 0, 0), values);
+    EXPECT_EQ(none, errors);
+    EXPECT_EQ(1u, allocated);
+}
+
+TEST_F(operation_count, move_constructor)
+{
+    expected other(value(1));
+    start();
+    expected e(std::move(other));
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 1, 0, 0, 0), values);
+    EXPECT_EQ(none, errors);
+    EXPECT_EQ(0u, allocated);
+}
+
+TEST_F(operation_count, storage_copies_non_const_lvalues)
+{
+    typedef eels::detail::storage_selector<value, error>::type storage;
+    storage other(eels::in_place, 1);
+    start();
+    storage s(other);
+    stop();
+    EXPECT_EQ(make_counters(0, 1, 0, 0, 0, 0), values) << "A non const storage should be copied, not forwarded to the constructor of a base layer.";
+    EXPECT_EQ(1, s.value().get());
+}
+
+TEST_F(operation_count, value_constructors)
+{
+    const value v(1);
+    start();
+    expected copied(v);
+    stop();
+    EXPECT_EQ(make_counters(0, 1, 0, 0, 0, 0), values);
+    EXPECT_EQ(1u, allocated);
+
+    value m(2);
+    start();
+    expected moved(std::move(m));
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 1, 0, 0, 0), values);
+    EXPECT_EQ(0u, allocated);
+}
+
+TEST_F(operation_count, in_place_constructors)
+{
+    start();
+    expected e(eels::in_place, 2, 3);
+    stop();
+    EXPECT_EQ(make_counters(1, 0, 0, 0, 0, 0), values);
+    EXPECT_EQ(none, errors);
+    EXPECT_EQ(1u, allocated);
+    EXPECT_EQ(6, e->get());
+
+    start();
+    expected f(eels::make_expected(2, 3));
+    stop();
+    EXPECT_EQ(make_counters(1, 0, 0, 0, 0, 0), values);
+    EXPECT_EQ(none, errors);
+    EXPECT_EQ(1u, allocated);
+    EXPECT_EQ(6, f->get());
+}
+
+TEST_F(operation_count, unexpected_constructors)
+{
+    start();
+    expected e(eels::unexpected, 2, 3);
+    stop();
+    EXPECT_EQ(none, values);
+    EXPECT_EQ(make_counters(1, 0, 0, 0, 0, 0), errors);
+    EXPECT_EQ(1u, allocated);
+    EXPECT_EQ(6, e.error().get());
+
+    start();
+    expected f(eels::make_unexpected(2, 3));
+    stop();
+    EXPECT_EQ(none, values);
+    EXPECT_EQ(make_counters(1, 0, 0, 0, 0, 0), errors);
+    EXPECT_EQ(1u, allocated);
+    EXPECT_EQ(6, f.error().get());
+}
+
+TEST_F(operation_count, copy_assignment)
+{
+    expected e(value(1));
+    const expected v(value(2));
+    const expected u(eels::unexpected, 3);
+
+    start();
+    e = v;
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 1, 0, 0), values) << "Same state: the value should be copy assigned.";
+    EXPECT_EQ(none, errors);
+    EXPECT_EQ(1u, allocated);
+
+    start();
+    e = u;
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 0, 1), values) << "Switching: the value should be destroyed.";
+    EXPECT_EQ(make_counters(0, 1, 1, 0, 0, 1), errors) << "Switching: the error may throw when copied, it is copied aside then moved in.";
+    EXPECT_EQ(1u, allocated);
+}
+
+TEST_F(operation_count, move_assignment)
+{
+    expected e(value(1));
+
+    expected v(value(2));
+    start();
+    e = std::move(v);
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 1, 0), values) << "Same state: the value should be move assigned, without temporary.";
+    EXPECT_EQ(none, errors);
+    EXPECT_EQ(0u, allocated);
+
+    expected u(eels::unexpected, 3);
+    start();
+    e = std::move(u);
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 0, 1), values) << "Switching: the value should be destroyed.";
+    EXPECT_EQ(make_counters(0, 0, 1, 0, 0, 0), errors) << "Switching: the error should be moved in, without temporary.";
+    EXPECT_EQ(0u, allocated);
+}
+
+TEST_F(operation_count, value_assignments)
+{
+    expected e(eels::unexpected, 1);
+    const value v(2);
+
+    start();
+    e = v;
+    stop();
+    EXPECT_EQ(make_counters(0, 1, 1, 0, 0, 1), values) << "Switching: the value may throw when copied, it is copied aside then moved in.";
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 0, 1), errors);
+    EXPECT_EQ(1u, allocated);
+
+    start();
+    e = v;
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 1, 0, 0), values) << "Same state: the value should be copy assigned.";
+    EXPECT_EQ(none, errors);
+
+    value m(3);
+    start();
+    e = std::move(m);
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 1, 0), values) << "Same state: the value should be move assigned.";
+    EXPECT_EQ(0u, allocated);
+}
+
+TEST_F(operation_count, in_place_assignment)
+{
+    expected e(value(1));
+
+    start();
+    e = eels::make_expected(2, 3);
+    stop();
+    EXPECT_EQ(make_counters(1, 0, 1, 0, 0, 2), values) << "Same state: the value may throw when constructed, it is constructed aside then moved in.";
+    EXPECT_EQ(none, errors);
+    EXPECT_EQ(1u, allocated);
+    EXPECT_EQ(6, e->get());
+
+    value m(4);
+    start();
+    e = eels::make_expected(std::move(m));
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 1, 0), values) << "Same state: a single value should be assigned.";
+    EXPECT_EQ(0u, allocated);
+
+    e = eels::make_unexpected(5);
+    start();
+    e = eels::make_expected(2, 3);
+    stop();
+    EXPECT_EQ(make_counters(1, 0, 1, 0, 0, 1), values) << "Switching: the value may throw when constructed, it is constructed aside then moved in.";
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 0, 1), errors);
+    EXPECT_EQ(1u, allocated);
+}
+
+TEST_F(operation_count, unexpected_assignment)
+{
+    expected e(eels::unexpected, 1);
+
+    start();
+    e = eels::make_unexpected(2, 3);
+    stop();
+    EXPECT_EQ(none, values);
+    EXPECT_EQ(make_counters(1, 0, 1, 0, 0, 2), errors) << "Same state: the error may throw when constructed, it is constructed aside then moved in.";
+    EXPECT_EQ(1u, allocated);
+    EXPECT_EQ(6, e.error().get());
+
+    error m(4);
+    start();
+    e = eels::make_unexpected(std::move(m));
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 1, 0), errors) << "Same state: a single error should be assigned.";
+    EXPECT_EQ(0u, allocated);
+
+    error n(5);
+    e = value(6);
+    start();
+    e = eels::make_unexpected(std::move(n));
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 0, 1), values);
+    EXPECT_EQ(make_counters(0, 0, 1, 0, 0, 0), errors) << "Switching: a single error should be moved in.";
+    EXPECT_EQ(0u, allocated);
+}
+
+TEST_F(operation_count, emplace)
+{
+    expected e(eels::unexpected, 1);
+
+    start();
+    value& v = e.emplace();
+    stop();
+    EXPECT_EQ(make_counters(1, 0, 0, 0, 0, 0), values) << "A nothrow construction should happen directly in the buffer.";
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 0, 1), errors);
+    EXPECT_EQ(0u, allocated);
+    EXPECT_EQ(&*e, &v);
+
+    start();
+    e.emplace();
+    stop();
+    EXPECT_EQ(make_counters(1, 0, 0, 0, 0, 1), values) << "A nothrow construction should replace the value in place.";
+    EXPECT_EQ(none, errors);
+
+    start();
+    e.emplace(2, 3);
+    stop();
+    EXPECT_EQ(make_counters(1, 0, 1, 0, 0, 2), values) << "A throwing construction should happen aside then be moved in.";
+    EXPECT_EQ(1u, allocated);
+    EXPECT_EQ(6, e->get());
+}
+
+TEST_F(operation_count, emplace_error)
+{
+    expected e(value(1));
+
+    start();
+    error& err = e.emplace_error();
+    stop();
+    EXPECT_EQ(make_counters(0, 0, 0, 0, 0, 1), values);
+    EXPECT_EQ(make_counters(1, 0, 0, 0, 0, 0), errors) << "A nothrow construction should happen directly in the buffer.";
+    EXPECT_EQ(0u, allocated);
+    EXPECT_EQ(&e.error(), &err);
+
+    start();
+    e.emplace_error(2, 3);
+    stop();
+    EXPECT_EQ(none, values);
+    EXPECT_EQ(make_counters(1, 0, 1, 0, 0, 2), errors) << "A throwing construction should happen aside then be moved in.";
+    EXPECT_EQ(1u, allocated);
+    EXPECT_EQ(6, e.error().get());
+}
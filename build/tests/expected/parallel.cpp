@@ -0,0 +1,153 @@
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <eels/expected.h>
+#include <eels/parallel.h>
+
+namespace {
+
+typedef eels::expected<int, std::string> result;
+
+std::vector<int> make_inputs(std::size_t size)
+{
+    std::vector<int> inputs(size);
+    std::iota(inputs.begin(), inputs.end(), 0);
+    return inputs;
+}
+
+// fails on every multiple of 'divisor' but 0
+class fail_on_multiples
+{
+public:
+    explicit fail_on_multiples(int divisor) : divisor(divisor) { }
+    result operator()(int v) const { return v && v % divisor == 0 ? result(eels::unexpected, std::to_string(v)) : result(v * 2); }
+    int divisor;
+};
+
+// random access iterator over the indices themselves, for ranges too large to exist
+class counting_iterator
+{
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef std::size_t value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const std::size_t* pointer;
+    typedef std::size_t reference;
+
+    explicit counting_iterator(std::size_t index) : index(index) { }
+    std::size_t operator[](std::ptrdiff_t offset) const { return index + static_cast<std::size_t>(offset); }
+    friend std::ptrdiff_t operator-(const counting_iterator& lhs, const counting_iterator& rhs) { return static_cast<std::ptrdiff_t>(lhs.index - rhs.index); }
+    std::size_t index;
+};
+
+eels::parallel_options make_options(eels::error_policy policy, std::size_t threads, std::size_t chunk_size)
+{
+    eels::parallel_options options;
+    options.policy = policy;
+    options.threads = threads;
+    options.chunk_size = chunk_size;
+    return options;
+}
+
+}
+
+TEST(parallel, collect)
+{
+    const std::vector<int> inputs = make_inputs(10000);
+    const eels::expected<std::vector<int>, std::string> collected = eels::parallel_collect(inputs.begin(), inputs.end(), [](int v) { return result(v * 2); });
+    ASSERT_TRUE(collected);
+    ASSERT_EQ(inputs.size(), collected->size());
+    for(std::size_t i = 0; i < inputs.size(); ++i)
+        ASSERT_EQ(inputs[i] * 2, (*collected)[i]) << "Values should be collected in the order of the elements.";
+}
+
+TEST(parallel, collect_moves_values)
+{
+    const std::vector<int> inputs = make_inputs(100);
+    auto collected = eels::parallel_collect(inputs.begin(), inputs.end(), [](int v) { return eels::expected<std::unique_ptr<int>, int>(std::unique_ptr<int>(new int(v))); });
+    ASSERT_TRUE(collected);
+    EXPECT_EQ(99, *collected->back());
+}
+
+TEST(parallel, empty_range)
+{
+    const std::vector<int> inputs;
+    EXPECT_TRUE(eels::parallel_collect(inputs.begin(), inputs.end(), fail_on_multiples(1))->empty());
+    EXPECT_EQ(5, *eels::parallel_transform_reduce(inputs.begin(), inputs.end(), 5, std::plus<int>(), fail_on_multiples(1)));
+}
+
+TEST(parallel, transform_reduce)
+{
+    const std::vector<int> inputs = make_inputs(10000);
+    const eels::expected<long long, std::string> sum = eels::parallel_transform_reduce(inputs.begin(), inputs.end(), 1ll, std::plus<long long>(), [](int v) { return result(v * 2); });
+    ASSERT_TRUE(sum);
+    EXPECT_EQ(1 + 9999ll * 10000, *sum);
+
+    // not commutative: the values must be combined in order
+    const std::vector<std::string> words = { "a", "b", "c", "d", "e", "f", "g", "h" };
+    const eels::expected<std::string, int> text = eels::parallel_transform_reduce(words.begin(), words.end(), std::string(">"), std::plus<std::string>(),
+        [](const std::string& w) { return eels::expected<std::string, int>(w); }, make_options(eels::error_policy::lowest_index, 0, 1));
+    ASSERT_TRUE(text);
+    EXPECT_EQ(">abcdefgh", *text);
+}
+
+TEST(parallel, lowest_index_error)
+{
+    const std::vector<int> inputs = make_inputs(100000);
+    for(std::size_t chunk_size : { 0, 1, 7, 1000 })
+    {
+        const eels::parallel_options options = make_options(eels::error_policy::lowest_index, 0, chunk_size);
+        EXPECT_EQ("999", eels::parallel_collect(inputs.begin(), inputs.end(), fail_on_multiples(999), options).error()) << "The error should be the one a sequential loop would return.";
+        EXPECT_EQ("999", eels::parallel_transform_reduce(inputs.begin(), inputs.end(), 0, std::plus<int>(), fail_on_multiples(999), options).error());
+    }
+}
+
+TEST(parallel, any_error)
+{
+    const std::vector<int> inputs = make_inputs(100000);
+    const eels::parallel_options options = make_options(eels::error_policy::any, 0, 0);
+    const eels::expected<std::vector<int>, std::string> collected = eels::parallel_collect(inputs.begin(), inputs.end(), fail_on_multiples(999), options);
+    ASSERT_FALSE(collected);
+    EXPECT_EQ(0, std::stoi(collected.error()) % 999) << "The error should be one of the elements that failed.";
+}
+
+TEST(parallel, cancels_after_an_error)
+{
+    const std::vector<int> inputs = make_inputs(10000);
+    std::atomic<int> calls(0);
+    auto counted = [&calls](int v) { ++calls; return fail_on_multiples(10)(v); };
+
+    // on a single thread, nothing after the first failure can run
+    eels::parallel_collect(inputs.begin(), inputs.end(), counted, make_options(eels::error_policy::lowest_index, 1, 0));
+    EXPECT_EQ(11, calls.load()) << "Elements after the error should be cancelled.";
+
+    calls = 0;
+    eels::parallel_collect(inputs.begin(), inputs.end(), counted, make_options(eels::error_policy::any, 0, 16));
+    EXPECT_LT(calls.load(), 10000) << "Elements after the error should be cancelled.";
+}
+
+TEST(parallel, exceptions)
+{
+    const std::vector<int> inputs = make_inputs(10000);
+    auto throwing = [](int v) { if(v == 5000) throw std::runtime_error("5000"); return result(v); };
+    EXPECT_THROW(eels::parallel_collect(inputs.begin(), inputs.end(), throwing), std::runtime_error) << "Exceptions should be rethrown to the caller.";
+
+    // an exception is a failure like any other, an error at a lower index wins
+    auto failing = [](int v) { if(v == 5000) throw std::runtime_error("5000"); return v == 10 ? result(eels::unexpected, "10") : result(v); };
+    EXPECT_EQ("10", eels::parallel_collect(inputs.begin(), inputs.end(), failing).error());
+}
+
+TEST(parallel, allocation_failures)
+{
+    // every chunk is too large for a vector of 'long long', reserving its values throws before any element is processed
+    const std::size_t size = std::size_t(1) << (sizeof(std::size_t) * 8 - 3);
+    auto identity = [](std::size_t v) { return eels::expected<long long, std::string>(static_cast<long long>(v)); };
+    EXPECT_THROW(eels::parallel_collect(counting_iterator(0), counting_iterator(size), identity, make_options(eels::error_policy::lowest_index, 2, size / 2)), std::length_error)
+        << "Failing to store the values should be rethrown to the caller.";
+}
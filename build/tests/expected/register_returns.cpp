@@ -0,0 +1,19 @@
+#include <eels/expected.h>
+
+// Compiled to assembly by 'check_register_returns.cmake', never linked:
+// an 'expected' returned in RAX:RDX is never written through the hidden result pointer the ABI passes in RDI otherwise.
+
+eels::expected<int, int> return_int_int(int v)
+{
+    return v < 0 ? eels::expected<int, int>(eels::unexpected, v) : eels::expected<int, int>(v);
+}
+
+eels::expected<long long, int> return_long_long_int(long long v)
+{
+    return v < 0 ? eels::expected<long long, int>(eels::unexpected, static_cast<int>(v)) : eels::expected<long long, int>(v);
+}
+
+eels::expected<int*, int> return_pointer_int(int* p)
+{
+    return p ? eels::expected<int*, int>(p) : eels::expected<int*, int>(eels::unexpected, 0);
+}
@@ -0,0 +1,148 @@
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <gtest/gtest.h>
+#include <eels/expected.h>
+
+namespace {
+
+// counts how many messages it formatted
+class http_domain
+    : public eels::status_domain
+{
+public:
+    http_domain() : formatted(0) { }
+
+    const char* name() const { return "http"; }
+    std::string message(int code) const
+    {
+        ++formatted;
+        return code == 404 ? "not found" : "http error " + std::to_string(code);
+    }
+
+    mutable int formatted;
+};
+
+http_domain& http()
+{
+    static http_domain domain;
+    return domain;
+}
+
+unsigned http_id()
+{
+    static const unsigned id = eels::register_status_domain(http());
+    return id;
+}
+
+}
+
+static_assert(sizeof(eels::status) == sizeof(void*), "A status is a single word.");
+static_assert(std::is_trivially_copyable<eels::status>::value, "A status is trivially copyable.");
+static_assert(std::is_same<eels::expected<int>, eels::expected<int, eels::status>>::value, "status is the default error type.");
+static_assert(sizeof(eels::expected<int>) <= 16, "An expected holding an int or a status fits in two registers.");
+static_assert(sizeof(std::uintptr_t) < 8 || sizeof(eels::expected<int>) == sizeof(eels::status), "On 64-bit platforms, the int lives next to the niche of the status.");
+#if !defined(EELS_EXPECTED_INSTRUMENT)
+static_assert(std::is_trivially_copyable<eels::expected<int>>::value, "An expected holding an int or a status is trivially copyable.");
+#endif
+
+TEST(status, packs_domain_and_code)
+{
+    const eels::status s(http_id(), 404);
+    EXPECT_EQ(http_id(), s.domain());
+    EXPECT_EQ(404, s.code());
+    EXPECT_EQ(nullptr, s.payload());
+
+    for(int code : { 0, -1, INT_MIN, INT_MAX })
+    {
+        const eels::status extreme(http_id(), code);
+        EXPECT_EQ(http_id(), extreme.domain());
+        EXPECT_EQ(code, extreme.code()) << "Codes that do not fit in the word should be kept in a record.";
+    }
+}
+
+TEST(status, interns_payloads)
+{
+    const std::string path = "/index.html";
+    const eels::status first(http_id(), 404, path);
+    const eels::status second(http_id(), 404, "/index.html");
+    ASSERT_NE(nullptr, first.payload());
+    EXPECT_STREQ("/index.html", first.payload());
+    EXPECT_EQ(first.payload(), second.payload()) << "Equal payloads should share their record.";
+    EXPECT_EQ(404, first.code());
+
+    const eels::status other(http_id(), 404, "/other.html");
+    EXPECT_NE(first.payload(), other.payload());
+    EXPECT_EQ(first, other) << "Statuses with the same domain and code should be equal, whatever their payloads.";
+    EXPECT_NE(first, eels::status(http_id(), 500));
+}
+
+TEST(status, null_payload_is_no_payload)
+{
+    const eels::status s(http_id(), 404, static_cast<const char*>(nullptr));
+    EXPECT_EQ(nullptr, s.payload());
+    EXPECT_EQ(404, s.code());
+    EXPECT_EQ("not found", s.message());
+    EXPECT_EQ(eels::status(http_id(), 404), s);
+}
+
+TEST(status, formats_messages_lazily)
+{
+    const eels::status s(http_id(), 404, "/index.html");
+    const int formatted = http().formatted;
+    const eels::status copy = s;
+    EXPECT_EQ(formatted, http().formatted) << "Creating and copying statuses should not format their messages.";
+
+    EXPECT_EQ("not found: /index.html", copy.message());
+    EXPECT_EQ(formatted + 1, http().formatted);
+    EXPECT_STREQ("http", copy.domain_name());
+}
+
+TEST(status, generic_and_unregistered_domains)
+{
+    const eels::status unspecified;
+    EXPECT_EQ(eels::generic_status_domain, unspecified.domain());
+    EXPECT_EQ(0, unspecified.code());
+    EXPECT_EQ("unspecified error", unspecified.message());
+
+    const eels::status generic(eels::generic_status_domain, ENOENT);
+    EXPECT_EQ(std::generic_category().message(ENOENT), generic.message());
+    EXPECT_STREQ("generic", generic.domain_name());
+
+    const eels::status unregistered(eels::detail::status_registry::max_domains - 1, 1);
+    EXPECT_STREQ("unregistered", unregistered.domain_name());
+}
+
+TEST(status, rejects_out_of_range_domains)
+{
+    const unsigned domain = eels::detail::status_registry::max_domains;
+    EXPECT_THROW(eels::status(domain, 1), std::out_of_range) << "The domain would alias domain 0 once packed.";
+    EXPECT_THROW(eels::status(domain, 1, "text"), std::out_of_range);
+    EXPECT_THROW(eels::status(domain, 1, std::string("text")), std::out_of_range);
+}
+
+TEST(status, expected_switches_between_value_and_status)
+{
+    eels::expected<int> e(-1);
+    ASSERT_TRUE(e);
+    EXPECT_EQ(-1, *e);
+
+    e = eels::make_unexpected(eels::status(http_id(), 404, "/index.html"));
+    ASSERT_FALSE(e) << "A status with a payload should not look like a value.";
+    EXPECT_STREQ("/index.html", e.error().payload());
+
+    e = 7;
+    ASSERT_TRUE(e);
+    EXPECT_EQ(7, *e);
+
+    e = eels::make_unexpected(eels::status(http_id(), 500));
+    ASSERT_FALSE(e) << "A packed status should not look like a value.";
+    EXPECT_EQ(500, e.error().code());
+
+    const eels::expected<int> copy = e;
+    ASSERT_FALSE(copy);
+    EXPECT_EQ(e.error(), copy.error());
+}
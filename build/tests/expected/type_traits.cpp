@@ -6,6 +6,22 @@ struct trivially_destructible
 { };
 struct non_trivially_destructible
 { ~non_trivially_destructible() { } };
+struct non_trivially_copy_constructible
+{
+    non_trivially_copy_constructible() { }
+    non_trivially_copy_constructible(const non_trivially_copy_constructible&) { }
+    non_trivially_copy_constructible(non_trivially_copy_constructible&&) = default;
+    non_trivially_copy_constructible& operator=(const non_trivially_copy_constructible&) = default;
+    non_trivially_copy_constructible& operator=(non_trivially_copy_constructible&&) = default;
+};
+struct non_trivially_move_assignable
+{
+    non_trivially_move_assignable() = default;
+    non_trivially_move_assignable(const non_trivially_move_assignable&) = default;
+    non_trivially_move_assignable(non_trivially_move_assignable&&) = default;
+    non_trivially_move_assignable& operator=(const non_trivially_move_assignable&) = default;
+    non_trivially_move_assignable& operator=(non_trivially_move_assignable&&) { return *this; }
+};
 
 TEST(type_traits, is_trivially_destructible)
 {
@@ -19,10 +35,66 @@ TEST(type_traits, is_trivially_destructible)
     EXPECT_FALSE((std::is_trivially_destructible<eels::expected<int, non_trivially_destructible>>::value)) << "An expected class with a non trivially destructible error type should not be trivially destructible itself.";
 }
 
+// Instrumented builds never use trivial special members, so that copies and moves can be counted.
+#if !defined(EELS_EXPECTED_INSTRUMENT)
+
+TEST(type_traits, is_trivially_copyable)
+{
+    EXPECT_TRUE((std::is_trivially_copyable<eels::expected<int, int>>::value)) << "An expected class made of trivially copyable types should be trivially copyable itself.";
+    EXPECT_TRUE((std::is_trivially_copyable<eels::expected<int, trivially_destructible>>::value)) << "An expected class made of trivially copyable types should be trivially copyable itself.";
+    EXPECT_TRUE((std::is_trivially_copyable<eels::expected<double, char>>::value)) << "An expected class made of trivially copyable types should be trivially copyable itself.";
+
+    EXPECT_FALSE((std::is_trivially_copyable<eels::expected<non_trivially_destructible, int>>::value)) << "An expected class with a non trivially destructible value type should not be trivially copyable itself.";
+    EXPECT_FALSE((std::is_trivially_copyable<eels::expected<int, non_trivially_copy_constructible>>::value)) << "An expected class with a non trivially copyable error type should not be trivially copyable itself.";
+}
+
+TEST(type_traits, conditionally_trivial_special_members)
+{
+    typedef eels::expected<non_trivially_copy_constructible, int> copy_type;
+    EXPECT_FALSE((std::is_trivially_copy_constructible<copy_type>::value)) << "The copy constructor should only be trivial when both types are trivially copy constructible.";
+    EXPECT_FALSE((std::is_trivially_copy_assignable<copy_type>::value)) << "The copy assignment should only be trivial when both types are trivially copy constructible.";
+    EXPECT_TRUE((std::is_trivially_move_constructible<copy_type>::value)) << "The move constructor should stay trivial when both types are trivially move constructible.";
+    EXPECT_TRUE((std::is_trivially_move_assignable<copy_type>::value)) << "The move assignment should stay trivial when both types are trivially movable.";
+    EXPECT_TRUE((std::is_trivially_destructible<copy_type>::value)) << "The destructor should stay trivial when both types are trivially destructible.";
+
+    typedef eels::expected<int, non_trivially_move_assignable> move_type;
+    EXPECT_TRUE((std::is_trivially_copy_constructible<move_type>::value)) << "The copy constructor should stay trivial when both types are trivially copy constructible.";
+    EXPECT_TRUE((std::is_trivially_move_constructible<move_type>::value)) << "The move constructor should stay trivial when both types are trivially move constructible.";
+    EXPECT_TRUE((std::is_trivially_copy_assignable<move_type>::value)) << "The copy assignment should stay trivial when both types are trivially copyable.";
+    EXPECT_FALSE((std::is_trivially_move_assignable<move_type>::value)) << "The move assignment should only be trivial when both types are trivially move assignable.";
+
+    typedef eels::expected<non_trivially_destructible, int> destructible_type;
+    EXPECT_FALSE((std::is_trivially_copy_assignable<destructible_type>::value)) << "The copy assignment should only be trivial when both types are trivially destructible.";
+    EXPECT_FALSE((std::is_trivially_move_assignable<destructible_type>::value)) << "The move assignment should only be trivial when both types are trivially destructible.";
+    EXPECT_TRUE((std::is_nothrow_move_constructible<destructible_type>::value)) << "A non trivial move constructor should stay noexcept when both types are nothrow move constructible.";
+}
+
+TEST(type_traits, eligible_for_register_returns)
+{
+    // The System V x86-64 ABI returns a trivially copyable class of at most two eightbytes of integers in RAX:RDX.
+    // Only these preconditions are checked here, the generated code is checked by 'check_register_returns.cmake'.
+    EXPECT_TRUE((std::is_trivially_copyable<eels::expected<long long, int>>::value && sizeof(eels::expected<long long, int>) <= 2 * sizeof(long long))) << "A small trivially copyable expected should be eligible for register returns.";
+    EXPECT_TRUE((std::is_trivially_copyable<eels::expected<int*, int>>::value && sizeof(eels::expected<int*, int>) <= 2 * sizeof(long long))) << "A small trivially copyable expected should be eligible for register returns.";
+    EXPECT_TRUE((std::is_trivially_copyable<eels::expected<int, int>>::value && sizeof(eels::expected<int, int>) <= sizeof(long long))) << "An expected of two ints should fit a single register.";
+}
+
+#else
+
+TEST(type_traits, instrumentation_disables_trivial_copies)
+{
+    EXPECT_FALSE((std::is_trivially_copyable<eels::expected<int, int>>::value)) << "Instrumented copies should go through the storage layers.";
+    EXPECT_TRUE((std::is_nothrow_move_constructible<eels::expected<int, int>>::value)) << "Instrumentation should not change exception specifications.";
+}
+
+#endif
+
+// Only Visual C++ accepts an 'expected' of void so far.
+#if defined(_MSC_VER)
 TEST(type_traits, compilation_succeeds_for_void_value_type)
 {
     eels::expected<void, int> e;
 }
+#endif
 
 //TEST(type_traits, compilation_fails_for_void_error_type)
 //{